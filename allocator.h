@@ -0,0 +1,107 @@
+#ifndef ALLOCATOR_H
+#define ALLOCATOR_H
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+using namespace std;
+class Tester;   // forward declaration, will be used for testing
+
+const size_t CACHELINE = 64;            // alignment of every table array
+const size_t HUGEPAGE = 2 * 1024 * 1024;// size of a huge page
+const int POOLBLOCKS = 4;               // freed blocks a PoolAllocator keeps for reuse
+
+// allocators of the table storage of a BasicCache (the values, control bytes, stored hashes, reference counters and
+// deadlines of each table). an allocator hands out raw memory, BasicCache constructs a value in a slot only when the
+// slot is first used, so a new table costs an allocation and not one constructor call per slot
+// an allocator has allocate(bytes) and deallocate(pointer, bytes), and is default constructible
+
+// default allocator, every array starts on a cache line
+struct HeapAllocator{
+    void* allocate(size_t bytes){
+        return ::operator new(bytes, align_val_t(CACHELINE));
+    }
+    void deallocate(void* pointer, size_t){
+        ::operator delete(pointer, align_val_t(CACHELINE));
+    }
+};
+
+// arrays of at least a huge page are aligned to one and the kernel is asked to back them with huge pages (Linux
+// transparent huge pages), so the probes of a large table miss the TLB less. smaller arrays come from HeapAllocator
+struct HugePageAllocator{
+    void* allocate(size_t bytes){
+        if (bytes < HUGEPAGE){
+            return HeapAllocator().allocate(bytes);
+        }
+        void* pointer = nullptr;
+        // rounds up to whole huge pages, the last one would else be backed by small pages
+        size_t size = (bytes + HUGEPAGE - 1) / HUGEPAGE * HUGEPAGE;
+        if (posix_memalign(&pointer, HUGEPAGE, size) != 0){
+            throw bad_alloc();
+        }
+#ifdef MADV_HUGEPAGE
+        madvise(pointer, size, MADV_HUGEPAGE);
+#endif
+        return pointer;
+    }
+    void deallocate(void* pointer, size_t bytes){
+        if (bytes < HUGEPAGE){
+            HeapAllocator().deallocate(pointer, bytes);
+        }else{
+            free(pointer);
+        }
+    }
+};
+
+// keeps up to POOLBLOCKS freed blocks and hands them out again for an allocation of the same size. a cache that
+// rehashes to the same capacity over and over (removes, eviction or expiry followed by a compaction) reuses the memory
+// of its last tables instead of getting new pages from the kernel each time. blocks of other sizes are freed when the
+// pool is full
+class PoolAllocator{
+public:
+    friend class Tester;
+    PoolAllocator(){
+        m_count = 0;
+    }
+    PoolAllocator(const PoolAllocator&) : PoolAllocator() {}
+    PoolAllocator& operator=(const PoolAllocator&) = delete;
+    ~PoolAllocator(){
+        for (int i = 0; i < m_count; i++){
+            m_heap.deallocate(m_blocks[i], m_sizes[i]);
+        }
+    }
+    void* allocate(size_t bytes){
+        for (int i = 0; i < m_count; i++){
+            if (m_sizes[i] == bytes){
+                void* pointer = m_blocks[i];
+                m_count--;
+                m_blocks[i] = m_blocks[m_count];
+                m_sizes[i] = m_sizes[m_count];
+                return pointer;
+            }
+        }
+        return m_heap.allocate(bytes);
+    }
+    void deallocate(void* pointer, size_t bytes){
+        // a full pool frees its first block to make room
+        if (m_count == POOLBLOCKS){
+            m_heap.deallocate(m_blocks[0], m_sizes[0]);
+            for (int i = 1; i < m_count; i++){
+                m_blocks[i - 1] = m_blocks[i];
+                m_sizes[i - 1] = m_sizes[i];
+            }
+            m_count--;
+        }
+        m_blocks[m_count] = pointer;
+        m_sizes[m_count] = bytes;
+        m_count++;
+    }
+private:
+    HeapAllocator m_heap;               // where the blocks come from
+    void*       m_blocks[POOLBLOCKS];   // freed blocks
+    size_t      m_sizes[POOLBLOCKS];    // size of each freed block
+    int         m_count;                // number of freed blocks
+};
+#endif
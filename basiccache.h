@@ -0,0 +1,1720 @@
+#ifndef BASICCACHE_H
+#define BASICCACHE_H
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "allocator.h"
+#include "sketch.h"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+using namespace std;
+class Tester;   // forward declaration, will be used for testing
+
+const int MINPRIME = 101;   // Min size for hash table
+const int MAXPRIME = 99991; // Max size for hash table given to the constructor
+const int MAXPOWER = 131072;// Max size for hash table given to the constructor in POWEROFTWO mode
+// largest capacities a table grows to. the stored hashes are 32 bits, so a table never has more slots than they can
+// tell apart: 2^32 in POWEROFTWO mode and the largest prime below 2^32 in PRIME mode
+const long long MAXGROWPOWER = 1LL << 32;
+const long long MAXGROWPRIME = 4294967291LL;
+const float DEFAULTLOAD = 0.5;// default load factor a table grows at, the largest one quadratic probing allows
+const float MAXGROWLOAD = 0.875;// largest load factor setMaxLoad accepts in POWEROFTWO mode
+// control byte states, one byte per slot kept in a separate array next to each table. the control byte is the only
+// record of whether a slot is empty, live or deleted, a removed value is left in its slot as dead data. a live slot
+// stores a 7-bit fingerprint of its hash (0..127) so probes can skip most non-matching values
+const signed char CTRLEMPTY = -128;
+const signed char CTRLDELETED = -2;
+const int GROUPWIDTH = 16;  // number of control bytes scanned at once by the SIMD helpers
+const int MIGRATECHUNK = 256;// old table slots the migrator thread scans each time it holds the lock
+const int MAXREFERENCE = 3; // largest reference counter of a slot in bounded mode, the hand passes it that many times
+// hierarchical timing wheel of the time to live of values: WHEELLEVELS levels of WHEELSIZE buckets, a bucket of level
+// l holds the deadlines of WHEELSIZE^l milliseconds (the wheel covers WHEELSIZE^WHEELLEVELS ms, about 4.6 hours)
+const int WHEELBITS = 6;
+const int WHEELSIZE = 1 << WHEELBITS;
+const int WHEELLEVELS = 4;
+const int EXPIREBUDGET = 16;// records and buckets the wheel handles in one insert or remove
+// capacity policy of a cache, chosen at construction
+// PRIME: prime capacities, hash % capacity and quadratic probing one slot at a time
+// POWEROFTWO: power of two capacities, multiply-shift instead of a division and triangular probing over groups of
+// GROUPWIDTH slots, which visits every slot of the table
+enum POLICY {PRIME, POWEROFTWO};
+// counters of a cache, see BasicCache::stats
+struct CacheStats{
+    unsigned long long m_hits;      // finds that found the value
+    unsigned long long m_misses;    // finds that did not
+    unsigned long long m_evictions; // values evicted by inserts in bounded mode
+    unsigned long long m_rejections;// inserts the admission policy turned away
+    unsigned long long m_expirations;// values removed because their time to live ran out
+};
+// deadline of a value in the timing wheel. the wheel does not know where the value is (rehashes and the transfer move
+// it), only its hash, so expiring a record removes every value with that hash whose own deadline has passed
+struct TimerRecord{
+    unsigned long long m_hash;  // hash of the value in the table it was inserted into
+    long long   m_deadline;     // time in milliseconds the value expires at
+};
+typedef long long (*clock_fn)(); // returns the time in milliseconds
+
+// default clock of a cache, milliseconds of the steady clock
+static inline long long steadyMillis(){
+    return chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// PackedKey<Key>::value is true if packedOf(const Key&) is declared next to Key (found by argument dependent lookup)
+// and returns 16 bits of the key, e.g. the ID of a PersonKey. a BasicCache of such a key keeps them in a dense array
+// next to the control bytes (see findIndex)
+template <class Key, class = void>
+struct PackedKey : false_type {};
+template <class Key>
+struct PackedKey<Key, void_t<decltype((unsigned short)packedOf(declval<const Key&>()))>> : true_type {};
+
+// returns the 16 bits of a key that is a PackedKey, 0 for any other key
+template <class Key>
+static inline auto packedBits(const Key& key, int) -> decltype((unsigned short)packedOf(key)){
+    return packedOf(key);
+}
+template <class Key>
+static inline unsigned short packedBits(const Key&, long){
+    return 0;
+}
+
+// hash table template behind Cache, for any record type
+// Key: type a value is looked up by
+// Value: record type stored in the table, must be default constructible and copyable. keyOf(const Value&) has to be
+//        declared next to Value (found by argument dependent lookup) and return its Key, or something KeyEqual
+//        compares with a Key
+// Hash: functor returning an unsigned int or unsigned long long hash of a Key. it is a template parameter, so the
+//       compiler sees the hash function and can inline it into the probe loops instead of calling it through a
+//       pointer. a 64-bit hash is folded into the 32 bits stored per slot (see foldHash), which pick the home slot,
+//       and its high half goes into the fingerprint, so in a table of 2^32 slots the fingerprint still filters
+// KeyEqual: functor comparing two keys
+// Allocator: where the storage of the tables comes from (see allocator.h). a slot is only constructed when a value is
+//            first inserted into it, and stays constructed (a removed value is left in it) until the table is freed
+// the tables are a struct of arrays: control bytes, stored hashes, the packed bits of each key if Key is a PackedKey,
+// and the values. a probe reads the small arrays and only reads a value when all of them match (see findIndex)
+// hashing is seeded. a Hash that can be called as hash(key, seed) gets the seed, for any other Hash the seed is mixed
+// into hash(key). the seed is 0 until the first reseed, which leaves the hashes of a Hash without a seed unchanged
+// open addressing with a current and an old table, the old table is drained into the current one incrementally after
+// a rehash (see Cache for the details of probing and rehashing)
+template <class Key, class Value, class Hash, class KeyEqual = equal_to<Key>, class Allocator = HeapAllocator>
+class BasicCache{
+public:
+    friend class Tester;
+    BasicCache(int size, const Hash& hash = Hash(), POLICY policy = PRIME, const KeyEqual& equal = KeyEqual(),
+               const Allocator& allocator = Allocator());
+    ~BasicCache();
+    // Returns Load factor of the new table
+    float lambda() const;
+    // Returns the ratio of deleted slots in the new table
+    float deletedRatio() const;
+    // insert only happens in the new table
+    bool insert(const Value& value);
+    // moves value into the table instead of copying it
+    bool insert(Value&& value);
+    // inserts value like insert, it expires ttl after the insert. an expired value is never found again, and is removed
+    // by the timing wheel a little later (or by the next insert or remove of its key). a ttl of 0 never expires
+    bool insert(const Value& value, chrono::milliseconds ttl);
+    // builds the value from args and moves it into the table
+    template <class... Args>
+    bool emplace(Args&&... args);
+    // inserts value unless a value with the same key is already stored. returns the stored value and whether it was
+    // inserted, or an empty value and false if the value cannot be inserted
+    pair<Value, bool> insertOrGet(Value value);
+    // remove can happen from either table
+    bool remove(const Key& key);
+    // find can happen in either table. returns a pointer to the value in the table, or nullptr if it is not found
+    // the pointer is only valid until the next insert or remove
+    const Value* find(const Key& key) const;
+    void dump() const;
+    // if an insert has to probe more than limit slots (limit groups in POWEROFTWO mode), the table picks a new random
+    // seed and rehashes with it, so a key set that collides under one seed is spread out again. 0 turns it off (the
+    // default). a reseed only happens if most values in the long probe sequence have other hashes than the inserted
+    // one, values with the same hash (e.g. many IDs of one key hashed by key only) stay together under any seed, and
+    // such a sequence is only checked again after limit more inserts. after a reseed the next one waits for as many
+    // inserts as the table has slots, and twice as many after every further reseed, so the rehashes cost O(1) per
+    // insert even if the keys keep colliding. Cache only gets the seed into its hash with a seeded_hash_fn
+    void setProbeLimit(int limit);
+    // limits the work each insert and remove does on the old table after a rehash. slots is the number of old table
+    // slots scanned per operation (live or not) and microseconds a time limit checked after every group of slots,
+    // 0 turns either one off. with both at 0 (the default) an operation transfers 25% of the old table's entries
+    // a budget never lets the old table outlive the current one, an operation scans at least as many slots as are
+    // needed to finish the old table before the current table has to grow
+    void setMigrationBudget(int slots, int microseconds = 0);
+    // starts or stops a migrator thread that transfers the old table after a rehash, so inserts and removes do not
+    // have to. an operation only helps with the transfer once the thread falls behind (see fillUpTable). while the
+    // thread runs every operation takes a lock, so find can be called from several threads at once as long as no
+    // thread inserts or removes. call it while no other thread uses the cache
+    void setBackgroundMigration(bool on);
+    // bounds the number of stored values. once entries values are stored, an insert evicts one before it inserts, so
+    // it only fails for a duplicate. the victim is chosen with CLOCK over the slots of the current table: every slot
+    // has a reference counter that find counts up to MAXREFERENCE, the hand evicts the first live slot with a counter
+    // of 0 and counts down the ones it passes. a new value starts at 0, so values that are never found again (e.g. a
+    // scan) are evicted on the first pass and the values that are found often survive it. 0 turns it off (the
+    // default), a limit below the number of stored values evicts down to it right away
+    void setEvictionLimit(int entries);
+    // sets the load factor the current table grows at (0.5 by default). in POWEROFTWO mode any load in
+    // [0.25-MAXGROWLOAD] works since the probing visits every group of the table, a higher one uses less memory per
+    // value for longer probe sequences. PRIME mode is limited to 0.5, quadratic probing only finds a free slot below it
+    void setMaxLoad(float load);
+    // turns the TinyLFU admission policy of a bounded cache on or off (off by default). every find and insert records
+    // the key in a FrequencySketch, and an insert into a full cache only evicts the victim if the new value is
+    // estimated to be used more often than the victim, else the insert fails and the victim stays. it only has an
+    // effect while there is an eviction limit
+    void setAdmission(bool on);
+    // returns the hits and misses of find and the evictions since the cache was made or resetStats was called
+    CacheStats stats() const;
+    void resetStats();
+    // removes expired values (see insert with a ttl), every insert and remove does it for up to EXPIREBUDGET records
+    // and wheel buckets, so a mass expiry is spread over many operations. if the removed values leave the table more
+    // than 80% deleted, it is rehashed like after removes
+    void expire();
+
+private:
+    static constexpr bool PACKED = PackedKey<Key>::value;// true if the tables keep the packed bits of every key
+
+    Hash        m_hasher;       // hash function
+    KeyEqual    m_equal;        // key comparison
+    Allocator   m_allocator;    // storage of the tables
+    POLICY      m_policy;       // capacity policy
+    float       m_maxLoad;      // load factor the current table grows at
+    int         m_probeLimit;   // probe length of an insert that triggers a reseed, 0 if reseeding is off
+    int         m_reseeds;      // number of reseeds so far
+    long long   m_reseedWait;   // inserts left before the next reseed is allowed
+    int         m_migrateSlots; // old table slots scanned per operation, 0 for 25% of the old table's entries
+    int         m_migrateMicros;// time limit of the transfer done by an operation, 0 if there is none
+    bool        m_background;   // true while the migrator thread runs
+    bool        m_stop;         // tells the migrator thread to exit
+    int         m_migratorChunks;// number of times the migrator thread transferred part of an old table
+    thread      m_migrator;     // migrator thread
+    mutable recursive_mutex m_lock;// guards the tables while the migrator thread runs
+    condition_variable_any m_wake;// wakes the migrator thread up after a rehash
+    int         m_evictLimit;   // number of values stored before an insert evicts one, 0 if the cache is unbounded
+    long long   m_hand;         // slot of the current table the CLOCK hand is at
+    mutable CacheStats m_stats; // hits, misses, evictions and rejections
+    bool        m_admission;    // true if the admission policy is on
+    FrequencySketch* m_sketch;  // access frequencies, nullptr unless the admission policy is on in a bounded cache
+    clock_fn    m_clock;        // time source of the deadlines
+    vector<TimerRecord>* m_wheel;// WHEELLEVELS * WHEELSIZE buckets of deadlines, nullptr until a value has a ttl
+    unsigned long long m_wheelMask[WHEELLEVELS];// bit i of level l is set if bucket i of the level is not empty
+    long long   m_wheelTime;    // every deadline before it has been expired
+    int         m_wheelCount;   // number of records in the wheel
+
+    Value*      m_currentTable; // hash table
+    signed char* m_currentCtrl; // control bytes of the current table (m_currentCap + GROUPWIDTH of them)
+    unsigned int* m_currentHashes;// full hash of the value in each live slot of the current table
+    unsigned short* m_currentPacked;// packed bits of the key in each live slot of the current table, nullptr if the
+                                // key is not a PackedKey
+    long long   m_currentCap;   // hash table size (capacity)
+    long long   m_currentSize;  // current number of entries
+    // m_currentSize includes deleted entries
+    long long   m_currNumDeleted;// number of deleted entries
+    unsigned long long m_currentMagic;// reciprocal of m_currentCap used to compute hash % m_currentCap
+    unsigned long long m_currentSeed;// seed of the hashes in the current table
+    unsigned char* m_currentRefs;// reference counter of each slot of the current table, nullptr if unbounded
+    long long*  m_currentDeadlines;// deadline of each slot of the current table (0 if none), nullptr until a ttl
+
+    Value*      m_oldTable;     // hash table
+    signed char* m_oldCtrl;     // control bytes of the old table
+    unsigned int* m_oldHashes;  // full hash of the value in each live slot of the old table
+    unsigned short* m_oldPacked;// packed bits of the key in each live slot of the old table
+    long long   m_oldCap;       // hash table size (capacity)
+    long long   m_oldSize;      // current number of entries
+    // m_oldSize includes deleted entries
+    long long   m_oldNumDeleted;// number of deleted entries
+    unsigned long long m_oldMagic;// reciprocal of m_oldCap used to compute hash % m_oldCap
+    unsigned long long m_oldSeed;// seed of the hashes in the old table
+    unsigned char* m_oldRefs;   // reference counter of each slot of the old table, nullptr if unbounded
+    long long*  m_oldDeadlines; // deadline of each slot of the old table, nullptr if the current one has none
+    long long   m_cursor;       // every slot of the old table before m_cursor has been transferred
+
+    //private helper functions
+    bool isPrime(long long number); // provided helper function to calculate validity of prime number
+    long long findNextPrime(long long current); // provided helper function to calculate prime number
+    long long findNextPowerOfTwo(long long current); // helper function to calculate power of two capacities
+    void setCapacity(long long current); // sets the capacity and reciprocal of a new table for the capacity policy
+    long long maxCapacity() const; // largest capacity of a table under the capacity policy
+    unsigned long long hashOf(const Key&, bool) const; // seeded hash of a key for the current or old table
+    long long home(unsigned long long, bool) const; // first slot of the probe sequence of a hash in a table
+    void setCtrl(signed char*, long long, long long, signed char) const; // writes a control byte of a table
+    void fillUpTable(); // helper function used to transfer nodes
+    void reHash(unsigned long long seed); // helper function to perform rehash operation with a seed
+    void deleteOld(); // deallocates old table
+    bool oldSearch(const Key&, unsigned long long); // removes values from old table
+    bool insertHelper(Value&, Value*, long long = 0); // single pass find-or-insert used by insert and insertOrGet
+    void hashFunctionHelper(long long); // quadratic probing helper
+    // probes the current or old table for a live value
+    long long findIndex(bool, unsigned long long, const Key&, long long* = nullptr, int* = nullptr) const;
+    long long findFree(unsigned long long) const; // probes the current table for a slot to insert into
+    bool spreadable(unsigned long long) const; // whether a new seed can shorten the probe sequence of a hash
+    long long minimumScan() const; // old table slots an operation has to scan to finish before the current table grows
+    // moves live nodes from oldTable to currentTable, starting at m_cursor
+    void transfer(long long, long long, long long = 0);
+    void migrate(); // body of the migrator thread
+    unique_lock<recursive_mutex> guard() const; // locks the tables if the migrator thread runs
+    signed char* newCtrl(long long); // allocates an all empty control byte array
+    template <class T>
+    T* allocateArray(long long); // allocates raw storage for an array from the allocator
+    template <class T>
+    void deallocateArray(T*, long long); // gives the storage of an array back to the allocator
+    unsigned short* newPacked(long long); // allocates a packed bits array if Key is a PackedKey, else returns nullptr
+    // destroys the used slots of a table and deallocates it
+    void freeTable(Value*, signed char*, unsigned int*, unsigned short*, long long);
+    void construct(Value*, signed char*, long long, Value&&); // moves a value into a free slot of a table
+    unsigned char* newRefs(long long); // allocates a reference counter array set to 0
+    long long* newDeadlines(long long); // allocates a deadline array set to 0
+    long long liveCount() const; // number of values stored in both tables
+    long long victim(bool&); // slot of the value the next eviction removes, in the old table if the flag is set
+    void evict(); // removes the value the CLOCK hand picks
+    unsigned int sketchHash(const Key&, unsigned long long, unsigned long long) const; // unseeded hash for the sketch
+    void resizeSketch(); // makes the sketch for the eviction limit, or deletes it
+    bool expired(bool, long long, long long) const; // whether a slot of the current or old table expired at a time
+    void expireSlot(bool, long long); // deletes an expired slot of the current or old table
+    void expireHash(bool, unsigned long long, long long); // deletes the expired values with a hash from a table
+    void schedule(unsigned long long, long long); // adds a deadline to the timing wheel
+    void place(const TimerRecord&); // puts a record into the wheel bucket for its deadline
+};
+
+// returns the 7-bit fingerprint of a hash which is stored in the control byte of a live slot
+// uses a different multiplier than home() so the fingerprint is independent of the slot in POWEROFTWO mode. the high
+// half of a 64-bit hash is multiplied in as well: the stored 32 bits pick the home slot (see foldHash), in a table of
+// 2^32 slots all of them, and only bits that are not folded into them keep the fingerprint useful there
+static inline signed char fingerprint(unsigned long long hash){
+    unsigned int stored = (unsigned int)(hash ^ (hash >> 32));
+    return (signed char)(((unsigned int)(hash >> 32) * 0x9E3779B9u + stored * 0x85EBCA6Bu) >> 25);
+}
+
+// returns a bitmask with bit i set if ctrl[i] is a live slot, for the GROUPWIDTH control bytes starting at ctrl
+// live slots are the only ones with the high bit clear, so SSE2 can test a whole group with one movemask
+static inline unsigned int liveMask(const signed char* ctrl){
+#ifdef __SSE2__
+    __m128i group = _mm_loadu_si128((const __m128i*)ctrl);
+    return ~(unsigned int)_mm_movemask_epi8(group) & 0xFFFF;
+#else
+    unsigned int mask = 0;
+    for (int i = 0; i < GROUPWIDTH; i++){
+        if (ctrl[i] >= 0)
+            mask |= 1u << i;
+    }
+    return mask;
+#endif
+}
+
+// returns a bitmask with bit i set if ctrl[i] == tag, for the GROUPWIDTH control bytes starting at ctrl
+static inline unsigned int matchMask(const signed char* ctrl, signed char tag){
+#ifdef __SSE2__
+    __m128i group = _mm_loadu_si128((const __m128i*)ctrl);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(tag)));
+#else
+    unsigned int mask = 0;
+    for (int i = 0; i < GROUPWIDTH; i++){
+        if (ctrl[i] == tag)
+            mask |= 1u << i;
+    }
+    return mask;
+#endif
+}
+
+// returns a bitmask with bit i set if ctrl[i] is an empty or deleted slot
+static inline unsigned int freeMask(const signed char* ctrl){
+    return ~liveMask(ctrl) & 0xFFFF;
+}
+
+// mixes a seed into the hash of a hasher that does not take a seed (murmur3 32-bit finalizer). for a fixed seed it
+// is a bijection, so different hashes stay different, and seed 0 returns the hash unchanged
+static inline unsigned int mixSeed(unsigned int hash, unsigned long long seed){
+    if (seed == 0)
+        return hash;
+    hash ^= (unsigned int)seed;
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35u;
+    hash ^= hash >> 16;
+    return hash ^ (unsigned int)(seed >> 32);
+}
+// mixes a seed into a 64-bit hash, each half on its own with its own seed so the halves stay independent
+static inline unsigned long long mixSeed(unsigned long long hash, unsigned long long seed){
+    if (seed == 0)
+        return hash;
+    return ((unsigned long long)mixSeed((unsigned int)(hash >> 32), seed * 0x9E3779B97F4A7C15ULL) << 32)
+        | mixSeed((unsigned int)hash, seed);
+}
+
+// folds a 64-bit hash into the 32 bits a table stores, keeping information from every bit. a 32-bit hash is returned
+// unchanged
+static inline unsigned int foldHash(unsigned long long hash){
+    return (unsigned int)(hash ^ (hash >> 32));
+}
+
+// returns hash(key, seed) if the hasher takes a seed, else hash(key) with the seed mixed in. the int/long argument
+// makes the first overload the better match when both are valid. the hash keeps all of its bits, the table only folds
+// it when it stores it
+template <class Hash, class Key>
+static inline auto seededHash(const Hash& hash, const Key& key, unsigned long long seed, int)
+    -> decltype((unsigned long long)hash(key, seed)){
+    return hash(key, seed);
+}
+template <class Hash, class Key>
+static inline unsigned long long seededHash(const Hash& hash, const Key& key, unsigned long long seed, long){
+    return mixSeed(hash(key), seed);
+}
+
+// every prime up to MAXPRIME, built by the compiler with a sieve of Eratosthenes so isPrime and findNextPrime are
+// table lookups instead of trial division. bit i of composite is set if i is not a prime
+struct PrimeTable {
+    unsigned char composite[MAXPRIME / 8 + 1];
+    constexpr PrimeTable() : composite() {
+        composite[0] = 3; // 0 and 1
+        for (int i = 2; i * i <= MAXPRIME; i++){
+            if (!(composite[i / 8] & (1 << (i % 8)))){
+                for (int j = i * i; j <= MAXPRIME; j += i)
+                    composite[j / 8] |= 1 << (j % 8);
+            }
+        }
+    }
+    constexpr bool prime(int number) const {
+        return !(composite[number / 8] & (1 << (number % 8)));
+    }
+};
+static constexpr PrimeTable PRIMES;
+
+// returns the reciprocal of divisor used by fastMod, computed once per table capacity
+static constexpr unsigned long long magic(long long divisor){
+    return ~0ULL / (unsigned int)divisor + 1;
+}
+
+// capacities a PRIME table grows through: MINPRIME, then each time the first prime above twice the one before, up to
+// MAXGROWPRIME. the compiler computes the fastMod reciprocal of each, so growing takes both from the table instead of
+// searching for the next prime by trial division above MAXPRIME
+const int GROWTHPRIMES = 27;
+struct GrowthTable {
+    long long prime[GROWTHPRIMES];
+    unsigned long long magic[GROWTHPRIMES];
+    constexpr GrowthTable() : prime{101, 211, 431, 863, 1733, 3467, 6947, 13901, 27803, 55609, 111227, 222461, 444929,
+        889871, 1779761, 3559537, 7119103, 14238221, 28476473, 56952947, 113905901, 227811809, 455623621, 911247257,
+        1822494581, 3644989199LL, MAXGROWPRIME}, magic() {
+        for (int i = 0; i < GROWTHPRIMES; i++){
+            magic[i] = ::magic(prime[i]);
+        }
+    }
+    // returns the index of the prime nearest to current, rounding up would quadruple a table that grows right after
+    // it went past the max load (2 * capacity + a few slots)
+    constexpr int nearest(long long current) const {
+        int i = 0;
+        while (i < GROWTHPRIMES - 1 && prime[i] < current){
+            i++;
+        }
+        return i > 0 && prime[i] > current * 1.4142 ? i - 1 : i;
+    }
+};
+static constexpr GrowthTable GROWTH;
+
+// returns value % divisor using the reciprocal of divisor instead of a division (Lemire's fastmod). the low 64 bits of
+// magic * value are the fractional part of value / divisor, multiplying them by divisor gives the remainder
+static inline long long fastMod(unsigned int value, unsigned long long magic, long long divisor){
+    unsigned long long fraction = magic * value;
+    return (long long)(((unsigned __int128)fraction * (unsigned int)divisor) >> 64);
+}
+
+// moves h to the next slot of the PRIME mode probe sequence, h = (h + count * count) % cap followed by count++
+// square holds count * count % cap and is updated with the difference between consecutive squares, so the step
+// only needs compares and subtractions
+static inline void nextProbe(long long& h, long long& square, long long& count, long long cap){
+    h += square;
+    if (h >= cap)
+        h -= cap;
+    long long difference = 2 * count + 1;
+    while (difference >= cap)
+        difference -= cap;
+    square += difference;
+    if (square >= cap)
+        square -= cap;
+    count++;
+}
+
+// BasicCache object constructor, initializes all old variables to 0/nullptr, makes the currenttable and sets all
+// other variables to 0. sets hash function
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+BasicCache<Key, Value, Hash, KeyEqual, Allocator>::BasicCache(int size, const Hash& hash, POLICY policy,
+                                                              const KeyEqual& equal, const Allocator& allocator)
+    : m_hasher(hash), m_equal(equal), m_allocator(allocator){
+    m_policy = policy;
+    m_maxLoad = DEFAULTLOAD;
+    m_probeLimit = 0;
+    m_reseeds = 0;
+    m_reseedWait = 0;
+    m_migrateSlots = 0;
+    m_migrateMicros = 0;
+    m_background = false;
+    m_stop = false;
+    m_migratorChunks = 0;
+    m_evictLimit = 0;
+    m_hand = 0;
+    m_stats = CacheStats{0, 0, 0, 0, 0};
+    m_admission = false;
+    m_sketch = nullptr;
+    m_clock = steadyMillis;
+    m_wheel = nullptr;
+    for (int level = 0; level < WHEELLEVELS; level++){
+        m_wheelMask[level] = 0;
+    }
+    m_wheelTime = 0;
+    m_wheelCount = 0;
+    m_currentSeed = 0;
+    m_oldSeed = 0;
+    // adjusting size if needed (needs to be in range of MINID and MAXID and needs to be a prime number
+    if (size < MINPRIME){
+        size = MINPRIME;
+    }else if (size > MAXPRIME){
+        size = MAXPRIME;
+    }
+    if (m_policy == POWEROFTWO){
+        m_currentCap = findNextPowerOfTwo(size);
+    }else if (!isPrime(size)){
+        m_currentCap = findNextPrime(size);
+    }else{
+        m_currentCap = size;
+    }
+    m_currentMagic = magic(m_currentCap);
+
+    // sets other variables to 0/nullptr
+    m_currentSize = 0;
+    m_oldCap = 0;
+    m_oldSize = 0;
+    m_currNumDeleted = 0;
+    m_oldNumDeleted = 0;
+    m_oldMagic = 0;
+    m_cursor = 0;
+    m_oldTable = nullptr;
+    m_oldCtrl = nullptr;
+    m_oldHashes = nullptr;
+    m_oldPacked = nullptr;
+    m_oldRefs = nullptr;
+    m_currentRefs = nullptr;
+    m_oldDeadlines = nullptr;
+    m_currentDeadlines = nullptr;
+    // creates current table, its slots are constructed as they are used
+    m_currentTable = allocateArray<Value>(m_currentCap);
+    m_currentCtrl = newCtrl(m_currentCap);
+    m_currentHashes = allocateArray<unsigned int>(m_currentCap);
+    m_currentPacked = newPacked(m_currentCap);
+}
+
+// BasicCache destructor, deallocates memory
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+BasicCache<Key, Value, Hash, KeyEqual, Allocator>::~BasicCache(){
+    // stops the migrator thread before the tables go away
+    setBackgroundMigration(false);
+    // deletes currenttable and oldtable
+    freeTable(m_currentTable, m_currentCtrl, m_currentHashes, m_currentPacked, m_currentCap);
+    m_currentTable = nullptr;
+    m_currentCtrl = nullptr;
+    m_currentHashes = nullptr;
+    m_currentPacked = nullptr;
+    if (m_oldTable != nullptr){
+        freeTable(m_oldTable, m_oldCtrl, m_oldHashes, m_oldPacked, m_oldCap);
+    }
+    m_oldTable = nullptr;
+    m_oldCtrl = nullptr;
+    m_oldHashes = nullptr;
+    m_oldPacked = nullptr;
+    deallocateArray(m_currentRefs, m_currentCap);
+    m_currentRefs = nullptr;
+    deallocateArray(m_oldRefs, m_oldCap);
+    m_oldRefs = nullptr;
+    delete m_sketch;
+    m_sketch = nullptr;
+    deallocateArray(m_currentDeadlines, m_currentCap);
+    m_currentDeadlines = nullptr;
+    deallocateArray(m_oldDeadlines, m_oldCap);
+    m_oldDeadlines = nullptr;
+    delete [] m_wheel;
+    m_wheel = nullptr;
+
+    // sets all other variables to 0
+    m_currentCap = 0;
+    m_currentSize = 0;
+    m_currNumDeleted = 0;
+    m_oldCap = 0;
+    m_oldNumDeleted = 0;
+    m_oldSize = 0;
+}
+
+// inserts value into the cache object, checks if a value with the same key already exists before inserting
+// rehashes if needed (lamba > max load) and transfers after every insertion operation
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+bool BasicCache<Key, Value, Hash, KeyEqual, Allocator>::insert(const Value& value){
+    Value copy = value;
+    return insertHelper(copy, nullptr);
+}
+
+// inserts value like insert, the value is moved into the table
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+bool BasicCache<Key, Value, Hash, KeyEqual, Allocator>::insert(Value&& value){
+    return insertHelper(value, nullptr);
+}
+
+// inserts value like insert, with a deadline ttl from now
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+bool BasicCache<Key, Value, Hash, KeyEqual, Allocator>::insert(const Value& value, chrono::milliseconds ttl){
+    Value copy = value;
+    return insertHelper(copy, nullptr, ttl.count() > 0 ? ttl.count() : 0);
+}
+
+// inserts a value built from args like insert
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+template <class... Args>
+bool BasicCache<Key, Value, Hash, KeyEqual, Allocator>::emplace(Args&&... args){
+    Value value(std::forward<Args>(args)...);
+    return insertHelper(value, nullptr);
+}
+
+// inserts value like insert, and returns the value that ends up stored under its key
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+pair<Value, bool> BasicCache<Key, Value, Hash, KeyEqual, Allocator>::insertOrGet(Value value){
+    Value existing;
+    Value copy = value;
+    if (insertHelper(copy, &existing)){
+        return make_pair(std::move(value), true);
+    }
+    return make_pair(existing, false);
+}
+
+// helper function for insert and insertOrGet. the duplicate check and the search for a free slot are done in the same
+// probe over the current table, and the value goes into the first deleted slot seen on the way (or the empty slot
+// that ended the probe). if the key is already stored and existing is not null, the stored value is copied into
+// existing. the value is moved into the table if it is inserted. it expires ttl milliseconds later if ttl is not 0
+// a stored value that expired does not count, it is deleted and the value is inserted in its place
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+bool BasicCache<Key, Value, Hash, KeyEqual, Allocator>::insertHelper(Value& value, Value* existing, long long ttl){
+    auto lock = guard();
+    expire();
+    long long now = ttl > 0 || m_currentDeadlines != nullptr ? m_clock() : 0;
+    // checks if the key has already been inserted before, in the current table and then in the old table
+    const auto& key = keyOf(value);
+    unsigned long long hash = hashOf(key, false);
+    if (m_sketch != nullptr){
+        m_sketch->record(sketchHash(key, hash, m_currentSeed));
+    }
+    long long h = -1;
+    int probes = 0;
+    long long found = findIndex(false, hash, key, &h, &probes);
+    if (found != -1 && expired(false, found, now)){
+        expireSlot(false, found);
+        found = findIndex(false, hash, key, &h, &probes);
+    }
+    if (found != -1){
+        if (existing != nullptr)
+            *existing = m_currentTable[found];
+        return false;
+    }
+    if (m_oldTable != nullptr){
+        found = findIndex(true, m_oldSeed == m_currentSeed ? hash : hashOf(key, true), key);
+        if (found != -1 && expired(true, found, now)){
+            expireSlot(true, found);
+            found = -1;
+        }
+        if (found != -1){
+            if (existing != nullptr)
+                *existing = m_oldTable[found];
+            return false;
+        }
+    }
+    if (h == -1){
+        return false;
+    }
+
+    // a bounded cache makes room by evicting a value (which leaves h free), else checks if a table that cannot grow
+    // anymore has room for the value under the max load. with the admission policy the value is only inserted if its
+    // key was used more often than the key of the victim
+    if (m_evictLimit > 0 && liveCount() >= m_evictLimit){
+        if (m_sketch != nullptr){
+            bool old;
+            long long index = victim(old);
+            unsigned int victimHash = old ? sketchHash(keyOf(m_oldTable[index]), m_oldHashes[index], m_oldSeed)
+                : sketchHash(keyOf(m_currentTable[index]), m_currentHashes[index], m_currentSeed);
+            if (m_sketch->frequency(sketchHash(key, hash, m_currentSeed)) <= m_sketch->frequency(victimHash)){
+                m_stats.m_rejections++;
+                return false;
+            }
+        }
+        evict();
+    }else if (m_currentCap >= maxCapacity() && liveCount() >= m_currentCap * (double)m_maxLoad){
+        return false;
+    }
+
+    // value is inserted into currentTable
+    if (m_currentCtrl[h] == CTRLDELETED){
+        m_currNumDeleted--;
+    }else{
+        m_currentSize++;
+    }
+    // key may refer to the value, its packed bits are stored before the value is moved
+    if (PACKED){
+        m_currentPacked[h] = packedBits(key, 0);
+    }
+    construct(m_currentTable, m_currentCtrl, h, std::move(value));
+    setCtrl(m_currentCtrl, m_currentCap, h, fingerprint(hash));
+    m_currentHashes[h] = foldHash(hash);
+    if (m_currentRefs != nullptr){
+        m_currentRefs[h] = 0;
+    }
+    if (ttl > 0 && m_currentDeadlines == nullptr){
+        m_currentDeadlines = newDeadlines(m_currentCap);
+        if (m_oldTable != nullptr){
+            m_oldDeadlines = newDeadlines(m_oldCap);
+        }
+    }
+    if (m_currentDeadlines != nullptr){
+        m_currentDeadlines[h] = ttl > 0 ? now + ttl : 0;
+        if (ttl > 0){
+            schedule(hash, now + ttl);
+        }
+    }
+
+    // if m_oldTable exists, will transfer part of it to current table (incremental transferring)
+    if (m_oldTable != nullptr){
+        fillUpTable();
+        // will deallocate m_oldTable if all entries in m_oldTable have been deleted
+        if (m_oldNumDeleted == m_oldSize){
+            deleteOld();
+        }
+    }
+
+    // if lamba > max load, rehashing needs to occur. also checks if m_oldTable doesn't exist to avoid cases where
+    // transferring and rehashing may occur simultaneously
+    // once m_currentCap is MAXGROWPRIME (MAXGROWPOWER in POWEROFTWO mode) the table cannot grow, it only rehashes to
+    // clear out deleted slots if they are more than a quarter of its entries
+    bool canGrow = m_currentCap < maxCapacity();
+    if (lambda() > m_maxLoad && m_oldTable == nullptr && (canGrow || m_currNumDeleted > m_currentSize/4)){
+        reHash(m_currentSeed);
+    }else if (m_probeLimit > 0 && probes > m_probeLimit && m_oldTable == nullptr && m_reseedWait == 0){
+        if (spreadable(hash)){
+            // the probe sequence of this insert was too long, the table is rehashed with a new random seed
+            random_device device;
+            m_reseedWait = m_currentCap << (m_reseeds < 20 ? m_reseeds : 20);
+            m_reseeds++;
+            reHash(((unsigned long long)device() << 32) | device());
+        }else{
+            // the sequence is mostly this hash, it is only checked again after limit more inserts
+            m_reseedWait = m_probeLimit;
+        }
+    }else if (m_reseedWait > 0){
+        m_reseedWait--;
+    }
+    return true;
+}
+
+// removes the value with the given key if it exists, and from all the tables it is in
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+bool BasicCache<Key, Value, Hash, KeyEqual, Allocator>::remove(const Key& key){
+    auto lock = guard();
+    expire();
+    bool removed = false;
+    // uses quadratic probing and the hash function to get the index of the key
+    unsigned long long hash = hashOf(key, false);
+    long long h = findIndex(false, hash, key);
+
+    // if the value is found in the current table, it is "deleted". an expired value was already gone
+    if (h != -1 && m_currentDeadlines != nullptr && expired(false, h, m_clock())){
+        expireSlot(false, h);
+    }else if (h != -1) {
+        setCtrl(m_currentCtrl, m_currentCap, h, CTRLDELETED);
+        m_currNumDeleted++;
+        removed = true;
+    }
+
+    // if oldTable exists, the value will also be removed from there if found (and not deleted already)
+    // then, it will incrementally transfer additional nodes in m_oldTable
+    if (m_oldTable != nullptr){
+        removed = oldSearch(key, m_oldSeed == m_currentSeed ? hash : hashOf(key, true)) || removed;
+        fillUpTable();
+
+        // if all elements in oldTable have been deleted, old table is deallocated
+        if (m_oldNumDeleted == m_oldSize){
+            deleteOld();
+        }
+    }
+
+    // if 80% of the current table is deleted (from its total size) and old table doesn't exist, will rehash. prevents
+    // rehashing and transferring from occurring simultaneously
+    if (deletedRatio() > 0.8 && m_oldTable == nullptr){
+        reHash(m_currentSeed);
+        // if all elements in oldTable have been deleted, old table is deallocated
+        if (m_oldNumDeleted == m_oldSize){
+            deleteOld();
+        }
+    }
+    return removed;
+}
+
+// returns a pointer to the value with the given key if found in either table, else returns nullptr
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+const Value* BasicCache<Key, Value, Hash, KeyEqual, Allocator>::find(const Key& key) const{
+    auto lock = guard();
+    // uses quadratic probing and hash function to get index of the value
+    unsigned long long hash = hashOf(key, false);
+    long long h = findIndex(false, hash, key);
+    if (m_sketch != nullptr){
+        m_sketch->record(sketchHash(key, hash, m_currentSeed));
+    }
+
+    // an expired value is not found any more
+    long long now = m_currentDeadlines != nullptr ? m_clock() : 0;
+    if (h != -1 && expired(false, h, now)){
+        m_stats.m_misses++;
+        return nullptr;
+    }
+
+    // if the value is found, will return the object. a bounded cache counts up its reference counter
+    if (h != -1){
+        m_stats.m_hits++;
+        if (m_currentRefs != nullptr && m_currentRefs[h] < MAXREFERENCE){
+            m_currentRefs[h]++;
+        }
+        return &m_currentTable[h];
+    }
+
+    // if the value is not found in the currentTable but oldTable exists, checks old table
+    if (m_oldTable != nullptr){
+        h = findIndex(true, m_oldSeed == m_currentSeed ? hash : hashOf(key, true), key);
+        if (h != -1 && !expired(true, h, now)){
+            m_stats.m_hits++;
+            if (m_oldRefs != nullptr && m_oldRefs[h] < MAXREFERENCE){
+                m_oldRefs[h]++;
+            }
+            return &m_oldTable[h];
+        }
+    }
+    m_stats.m_misses++;
+    return nullptr;
+}
+
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+float BasicCache<Key, Value, Hash, KeyEqual, Allocator>::lambda() const {
+    auto lock = guard();
+    return float(m_currentSize)/ float(m_currentCap);
+}
+
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+float BasicCache<Key, Value, Hash, KeyEqual, Allocator>::deletedRatio() const {
+    auto lock = guard();
+
+    return float(m_currNumDeleted)/float(m_currentSize);
+}
+
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+void BasicCache<Key, Value, Hash, KeyEqual, Allocator>::setProbeLimit(int limit) {
+    m_probeLimit = limit;
+}
+
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+void BasicCache<Key, Value, Hash, KeyEqual, Allocator>::setMigrationBudget(int slots, int microseconds) {
+    m_migrateSlots = slots;
+    m_migrateMicros = microseconds;
+}
+
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+void BasicCache<Key, Value, Hash, KeyEqual, Allocator>::setBackgroundMigration(bool on) {
+    if (on && !m_background){
+        m_stop = false;
+        m_background = true;
+        m_migrator = thread(&BasicCache::migrate, this);
+    }else if (!on && m_background){
+        {
+            lock_guard<recursive_mutex> lock(m_lock);
+            m_stop = true;
+        }
+        m_wake.notify_one();
+        m_migrator.join();
+        m_background = false;
+    }
+}
+
+// the reference counters only exist while the cache is bounded, they start at 0 for the values already stored
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+void BasicCache<Key, Value, Hash, KeyEqual, Allocator>::setEvictionLimit(int entries) {
+    auto lock = guard();
+    m_evictLimit = entries > 0 ? entries : 0;
+    if (m_evictLimit > 0 && m_currentRefs == nullptr){
+        m_currentRefs = newRefs(m_currentCap);
+        if (m_oldTable != nullptr){
+            m_oldRefs = newRefs(m_oldCap);
+        }
+        m_hand = 0;
+    }else if (m_evictLimit == 0){
+        deallocateArray(m_currentRefs, m_currentCap);
+        m_currentRefs = nullptr;
+        deallocateArray(m_oldRefs, m_oldCap);
+        m_oldRefs = nullptr;
+    }
+    while (m_evictLimit > 0 && liveCount() > m_evictLimit){
+        evict();
+    }
+    resizeSketch();
+}
+
+// the load is clamped to what the capacity policy allows, a table already above it grows with the next insert
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+void BasicCache<Key, Value, Hash, KeyEqual, Allocator>::setMaxLoad(float load) {
+    auto lock = guard();
+    float highest = m_policy == POWEROFTWO ? MAXGROWLOAD : DEFAULTLOAD;
+    m_maxLoad = load < 0.25f ? 0.25f : (load > highest ? highest : load);
+}
+
+// the sketch starts empty, and is made again whenever the eviction limit changes
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+void BasicCache<Key, Value, Hash, KeyEqual, Allocator>::setAdmission(bool on) {
+    auto lock = guard();
+    m_admission = on;
+    resizeSketch();
+}
+
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+CacheStats BasicCache<Key, Value, Hash, KeyEqual, Allocator>::stats() const {
+    auto lock = guard();
+    return m_stats;
+}
+
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+void BasicCache<Key, Value, Hash, KeyEqual, Allocator>::resetStats() {
+    auto lock = guard();
+    m_stats = CacheStats{0, 0, 0, 0, 0};
+}
+
+// goes through the wheel up to the current time, highest level first at the start of a bucket of a higher level: the
+// records of the bucket of a higher level that starts now are put into the lower levels, and the records of the level
+// 0 bucket of now are expired. empty buckets of level 0 are skipped with the bitmask. stops after EXPIREBUDGET
+// records and buckets and goes on from there next time
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+void BasicCache<Key, Value, Hash, KeyEqual, Allocator>::expire() {
+    auto lock = guard();
+    if (m_wheelCount == 0){
+        return;
+    }
+    long long now = m_clock();
+    int work = 0;
+    while (m_wheelTime <= now && work < EXPIREBUDGET){
+        long long time = m_wheelTime;
+        bool cascaded = true;
+        for (int level = WHEELLEVELS - 1; level >= 1 && cascaded; level--){
+            if (time & ((1LL << (WHEELBITS * level)) - 1)){
+                continue;
+            }
+            int index = (time >> (WHEELBITS * level)) & (WHEELSIZE - 1);
+            vector<TimerRecord>& bucket = m_wheel[level * WHEELSIZE + index];
+            while (!bucket.empty() && work < EXPIREBUDGET){
+                TimerRecord record = bucket.back();
+                bucket.pop_back();
+                place(record);
+                work++;
+            }
+            if (bucket.empty()){
+                m_wheelMask[level] &= ~(1ULL << index);
+            }else{
+                cascaded = false;
+            }
+        }
+        if (!cascaded){
+            break;
+        }
+
+        int index = time & (WHEELSIZE - 1);
+        vector<TimerRecord>& bucket = m_wheel[index];
+        while (!bucket.empty() && work < EXPIREBUDGET){
+            unsigned long long hash = bucket.back().m_hash;
+            bucket.pop_back();
+            m_wheelCount--;
+            expireHash(false, hash, now);
+            if (m_oldTable != nullptr){
+                expireHash(true, hash, now);
+            }
+            work++;
+        }
+        if (!bucket.empty()){
+            break;
+        }
+        m_wheelMask[0] &= ~(1ULL << index);
+        // jumps to the first tick a bucket is due at, so empty ticks and blocks cost nothing. a bucket of level l is
+        // due at the next tick that is a multiple of WHEELSIZE^l and falls into it, for every level that is the
+        // nearest non-empty bucket after the current one (cyclically, a bucket can be up to a whole turn ahead)
+        long long next = now + 1;
+        for (int level = 0; level < WHEELLEVELS; level++){
+            unsigned long long mask = m_wheelMask[level];
+            if (mask == 0){
+                continue;
+            }
+            int shift = WHEELBITS * level;
+            int start = ((time >> shift) + 1) & (WHEELSIZE - 1);
+            // rotates the mask so bit 0 is the bucket after the current one
+            unsigned long long rotated = start == 0 ? mask : (mask >> start) | (mask << (WHEELSIZE - start));
+            long long due = ((time >> shift) + 1 + __builtin_ctzll(rotated)) << shift;
+            next = due < next ? due : next;
+        }
+        m_wheelTime = next;
+        work++;
+    }
+
+    // a mass expiry compacts the table like a mass removal
+    if (deletedRatio() > 0.8 && m_oldTable == nullptr){
+        reHash(m_currentSeed);
+        if (m_oldNumDeleted == m_oldSize){
+            deleteOld();
+        }
+    }
+}
+
+// provided function
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+void BasicCache<Key, Value, Hash, KeyEqual, Allocator>::dump() const {
+    auto lock = guard();
+    cout << "Dump for the current table: " << endl;
+    if (m_currentTable != nullptr)
+        for (long long i = 0; i < m_currentCap; i++) {
+            cout << "[" << i << "] : ";
+            if (m_currentCtrl[i] >= 0)
+                cout << m_currentTable[i];
+            cout << endl;
+        }
+    cout << "Dump for the old table: " << endl;
+    if (m_oldTable != nullptr)
+        for (long long i = 0; i < m_oldCap; i++) {
+            cout << "[" << i << "] : ";
+            if (m_oldCtrl[i] >= 0)
+                cout << m_oldTable[i];
+            cout << endl;
+        }
+}
+
+// provided function, returns if isPrime. numbers up to MAXPRIME are looked up in the compile time prime table, larger
+// ones are checked by trial division (growing tables take their primes from the growth table instead)
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+bool BasicCache<Key, Value, Hash, KeyEqual, Allocator>::isPrime(long long number){
+    if (number <= MAXPRIME){
+        return number >= 0 && PRIMES.prime(number);
+    }
+    for (long long i = 2; i <= number / i; ++i) {
+        if (number % i == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// provided function, returns next prime number
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+long long BasicCache<Key, Value, Hash, KeyEqual, Allocator>::findNextPrime(long long current){
+    //we always stay within the range [MINPRIME-MAXGROWPRIME]
+    //the smallest prime starts at MINPRIME
+    if (current < MINPRIME) current = MINPRIME-1;
+    for (long long i=current+1; i<MAXGROWPRIME; i++) {
+        if (isPrime(i)) {
+            return i;
+        }
+    }
+    //if a table tries to grow over MAXGROWPRIME
+    return MAXGROWPRIME;
+}
+
+// helper function, returns the smallest power of two that is at least current, in the range [MINPRIME-MAXGROWPOWER]
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+long long BasicCache<Key, Value, Hash, KeyEqual, Allocator>::findNextPowerOfTwo(long long current){
+    long long power = 1;
+    while ((power < current || power < MINPRIME) && power < MAXGROWPOWER){
+        power <<= 1;
+    }
+    return power;
+}
+
+// helper function, sets the capacity of a new current table of about current slots under the capacity policy and
+// its fastMod reciprocal. in POWEROFTWO mode it is the power of two nearest to current, rounding up would quadruple a
+// table that grows right after it went past the max load (2 * capacity + a few slots). in PRIME mode both come from
+// the nearest prime of the growth table
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+void BasicCache<Key, Value, Hash, KeyEqual, Allocator>::setCapacity(long long current){
+    if (m_policy == POWEROFTWO){
+        long long power = findNextPowerOfTwo(current);
+        m_currentCap = power / 2 >= MINPRIME && power > current * 1.4142 ? power / 2 : power;
+        m_currentMagic = magic(m_currentCap);
+    }else{
+        int index = GROWTH.nearest(current);
+        m_currentCap = GROWTH.prime[index];
+        m_currentMagic = GROWTH.magic[index];
+    }
+}
+
+// helper function, returns the capacity a table stops growing at under the capacity policy
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+long long BasicCache<Key, Value, Hash, KeyEqual, Allocator>::maxCapacity() const {
+    return m_policy == POWEROFTWO ? MAXGROWPOWER : MAXGROWPRIME;
+}
+
+// helper function, returns the hash of a key with the seed of the current or old table
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+unsigned long long BasicCache<Key, Value, Hash, KeyEqual, Allocator>::hashOf(const Key& key, bool old) const {
+    return seededHash(m_hasher, key, old ? m_oldSeed : m_currentSeed, 0);
+}
+
+// helper function, returns the slot a probe sequence for hash starts at in the current or old table, from the 32 bits
+// of the hash a table stores
+// PRIME mode computes hash % capacity with the precomputed reciprocal of the capacity (a multiply and a shift)
+// POWEROFTWO mode takes the top bits of a multiplicative (fibonacci) hash, which avoids the division of % and still
+// uses every bit of the hash
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+long long BasicCache<Key, Value, Hash, KeyEqual, Allocator>::home(unsigned long long hash, bool old) const {
+    long long cap = old ? m_oldCap : m_currentCap;
+    unsigned int stored = foldHash(hash);
+    if (m_policy == POWEROFTWO){
+        return (stored * 0x9E3779B9u) >> (32 - __builtin_ctzll(cap));
+    }
+    return fastMod(stored, old ? m_oldMagic : m_currentMagic, cap);
+}
+
+// helper function, writes the control byte of slot index in a table. in POWEROFTWO mode the first GROUPWIDTH bytes are
+// mirrored after the end of the table so a group loaded near the end wraps around to the start
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+void BasicCache<Key, Value, Hash, KeyEqual, Allocator>::setCtrl(signed char* ctrl, long long cap, long long index,
+                                                                signed char value) const {
+    ctrl[index] = value;
+    if (m_policy == POWEROFTWO && index < GROUPWIDTH){
+        ctrl[cap + index] = value;
+    }
+}
+
+// helper function for transferring part of oldTable to currentTable (incremental transfer), 25% of the nodes or as
+// many slots as the migration budget allows. the scan goes on from where the last one stopped
+// with a migrator thread an operation leaves the transfer to the thread until it falls behind, i.e. until more than
+// two slots per operation are needed to finish the old table in time or the rest has to be finished now, and then
+// scans just as many as needed
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+void BasicCache<Key, Value, Hash, KeyEqual, Allocator>::fillUpTable() {
+    if (m_background){
+        long long minimum = minimumScan();
+        if (minimum > 2 || minimum >= m_oldCap - m_cursor){
+            transfer(m_oldCap, minimum, minimum);
+        }
+    }else if (m_migrateSlots > 0 || m_migrateMicros > 0){
+        // scans the budgeted number of slots, but never less than needed to finish in time
+        long long minimum = minimumScan();
+        long long slots = m_migrateSlots > 0 ? m_migrateSlots : m_oldCap;
+        transfer(m_oldCap, slots > minimum ? slots : minimum, minimum);
+    }else{
+        // calculates 25% of oldSize
+        long long fourth = m_oldSize*0.25;
+
+        // if the number of live nodes is not less than 25% of old size, transfers 25% of oldSize
+        // else for "remainders", transfers the rest of the nodes (less than 25% of oldSize)
+        transfer(m_oldSize-m_oldNumDeleted >= fourth ? fourth : m_oldCap, m_oldCap);
+    }
+    // every live node has been transferred once the scan reaches the end
+    if (m_cursor >= m_oldCap){
+        m_oldNumDeleted = m_oldSize;
+    }
+}
+
+// helper function, rehashes if lamba > max load or deletedRatio > 0.8, or with a new seed after a long probe sequence
+// the new table uses the given seed
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+void BasicCache<Key, Value, Hash, KeyEqual, Allocator>::reHash(unsigned long long seed) {
+    // copies all current variables to old variables and gets 25% of oldSize
+    m_oldCap = m_currentCap;
+    m_oldMagic = m_currentMagic;
+    m_oldSeed = m_currentSeed;
+    m_currentSeed = seed;
+    m_oldSize = m_currentSize;
+    m_oldNumDeleted = m_currNumDeleted;
+    long long fourth = m_oldSize * 0.25;
+    // the values, control bytes and stored hashes are handed over as they are, nothing is copied
+    m_oldTable = m_currentTable;
+    m_oldCtrl = m_currentCtrl;
+    m_oldHashes = m_currentHashes;
+    m_oldPacked = m_currentPacked;
+    m_oldRefs = m_currentRefs;
+    m_oldDeadlines = m_currentDeadlines;
+
+    // builds the new current table
+    // the live entries fill the new table to about half the max load, so a growing table doubles
+    setCapacity((long long)((m_currentSize-m_currNumDeleted) * 2 / (double)m_maxLoad));
+    m_currNumDeleted = 0;
+    m_currentTable = allocateArray<Value>(m_currentCap);
+    m_currentCtrl = newCtrl(m_currentCap);
+    m_currentHashes = allocateArray<unsigned int>(m_currentCap);
+    m_currentPacked = newPacked(m_currentCap);
+    m_currentRefs = m_oldRefs != nullptr ? newRefs(m_currentCap) : nullptr;
+    m_currentDeadlines = m_oldDeadlines != nullptr ? newDeadlines(m_currentCap) : nullptr;
+    m_currentSize = 0;
+    m_hand = 0;
+
+    // transfers 25% of oldSize to the current table, or the first part allowed by the migration budget, or wakes
+    // the migrator thread up
+    m_cursor = 0;
+    if (m_background){
+        m_wake.notify_one();
+    }else if (m_migrateSlots > 0 || m_migrateMicros > 0){
+        fillUpTable();
+    }else{
+        transfer(fourth-1, m_oldCap);
+    }
+}
+
+// helper function, deallocates old variables
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+void BasicCache<Key, Value, Hash, KeyEqual, Allocator>::deleteOld() {
+    freeTable(m_oldTable, m_oldCtrl, m_oldHashes, m_oldPacked, m_oldCap);
+    deallocateArray(m_oldRefs, m_oldCap);
+    m_oldRefs = nullptr;
+    deallocateArray(m_oldDeadlines, m_oldCap);
+    m_oldDeadlines = nullptr;
+    m_oldNumDeleted = 0;
+    m_oldSeed = m_currentSeed;
+    m_oldCap = 0;
+    m_oldSize = 0;
+    m_oldMagic = 0;
+    m_cursor = 0;
+    m_oldTable = nullptr;
+    m_oldCtrl = nullptr;
+    m_oldHashes = nullptr;
+    m_oldPacked = nullptr;
+}
+
+// helper function, removes the value with the given key from oldTable if found
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+bool BasicCache<Key, Value, Hash, KeyEqual, Allocator>::oldSearch(const Key& key, unsigned long long hash) {
+    // uses quadratic probing and hash function to find index of the value in oldTable
+    long long h = findIndex(true, hash, key);
+
+    // if the value is found in oldTable, it is removed. an expired value was already gone
+    if (h != -1 && m_oldDeadlines != nullptr && expired(true, h, m_clock())){
+        expireSlot(true, h);
+    }else if (h != -1) {
+        setCtrl(m_oldCtrl, m_oldCap, h, CTRLDELETED);
+        m_oldNumDeleted++;
+        return true;
+    }
+    return false;
+}
+
+// helper function, helps insert objects from old table to current table using quadratic probing and hash function
+// the old slot is marked as deleted afterwards. the stored hash and fingerprint are reused so the key is never hashed
+// again, unless the current table has a new seed
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+void BasicCache<Key, Value, Hash, KeyEqual, Allocator>::hashFunctionHelper(long long index) {
+    // quadratic probing to find space for the value (empty or deleted)
+    bool reseeded = m_oldSeed != m_currentSeed;
+    unsigned long long hash = reseeded ? hashOf(keyOf(m_oldTable[index]), false) : m_oldHashes[index];
+    long long h = findFree(hash);
+
+    // if a space is found, inserts the value in currentTable
+    if (h != -1){
+        if (m_currentCtrl[h] == CTRLDELETED){
+            m_currNumDeleted--;
+        }else{
+            m_currentSize++;
+        }
+        // the old slot is deleted right after, so the value is moved instead of copied. the migrator thread copies
+        // it, a pointer returned by find to the old value has to stay valid until the next insert or remove
+        if (m_background){
+            construct(m_currentTable, m_currentCtrl, h, Value(m_oldTable[index]));
+        }else{
+            construct(m_currentTable, m_currentCtrl, h, std::move(m_oldTable[index]));
+        }
+        setCtrl(m_currentCtrl, m_currentCap, h, reseeded ? fingerprint(hash) : m_oldCtrl[index]);
+        m_currentHashes[h] = foldHash(hash);
+        if (PACKED){
+            m_currentPacked[h] = m_oldPacked[index];
+        }
+        if (m_currentRefs != nullptr){
+            m_currentRefs[h] = m_oldRefs[index];
+        }
+        // a value that moves to a table with another seed gets a new hash, and a wheel record with it
+        if (m_currentDeadlines != nullptr){
+            m_currentDeadlines[h] = m_oldDeadlines[index];
+            if (m_oldDeadlines[index] != 0 && reseeded){
+                schedule(hash, m_oldDeadlines[index]);
+            }
+        }
+        m_oldNumDeleted++;
+    }
+    setCtrl(m_oldCtrl, m_oldCap, index, CTRLDELETED);
+}
+
+// helper function, returns the number of old table slots an operation has to scan so the old table is finished
+// before the current table reaches the max load. every insert adds one entry to the current table, so the
+// inserts left are the free room under the max load minus the live nodes still waiting in the old table
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+long long BasicCache<Key, Value, Hash, KeyEqual, Allocator>::minimumScan() const {
+    long long left = m_oldCap - m_cursor;
+    long long room = (long long)(m_currentCap * (double)m_maxLoad) - m_currentSize - (m_oldSize-m_oldNumDeleted);
+    if (room <= 1){
+        return left;
+    }
+    return (left + room - 1) / room;
+}
+
+// helper function, moves up to num live nodes from oldTable to currentTable, scanning at most slots slots from
+// m_cursor on. scans the control bytes of oldTable GROUPWIDTH slots at a time so runs of deleted/empty slots are
+// skipped without touching the values. with a migration time limit the scan also stops once the time is up, but not
+// before minimum slots are scanned
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+void BasicCache<Key, Value, Hash, KeyEqual, Allocator>::transfer(long long num, long long slots, long long minimum) {
+    chrono::steady_clock::time_point deadline;
+    if (m_migrateMicros > 0){
+        deadline = chrono::steady_clock::now() + chrono::microseconds(m_migrateMicros);
+    }
+    long long start = m_cursor;
+    long long end = slots < m_oldCap - m_cursor ? m_cursor + slots : m_oldCap;
+    long long counter = 0;
+    while (m_cursor < end && counter < num){
+        long long width = end - m_cursor < GROUPWIDTH ? end - m_cursor : GROUPWIDTH;
+        unsigned int mask = liveMask(m_oldCtrl + m_cursor);
+        // the control bytes past end are not part of this scan (past m_oldCap they are padding or mirrored bytes)
+        if (width < GROUPWIDTH){
+            mask &= (1u << width) - 1;
+        }
+        long long next = m_cursor + width;
+        while (mask != 0 && counter < num){
+            long long index = m_cursor + __builtin_ctz(mask);
+            mask &= mask - 1;
+            hashFunctionHelper(index);
+            counter++;
+            // the rest of the group is left for the next scan
+            if (counter == num){
+                next = index + 1;
+            }
+        }
+        m_cursor = next;
+        if (m_migrateMicros > 0 && m_cursor - start >= minimum && chrono::steady_clock::now() >= deadline){
+            break;
+        }
+    }
+}
+
+// body of the migrator thread, transfers MIGRATECHUNK old table slots at a time and releases the lock in between so
+// the other operations can go on. sleeps while there is no old table left to scan. the old table itself is
+// deallocated by the next insert or remove
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+void BasicCache<Key, Value, Hash, KeyEqual, Allocator>::migrate() {
+    unique_lock<recursive_mutex> lock(m_lock);
+    while (!m_stop){
+        if (m_oldTable != nullptr && m_cursor < m_oldCap){
+            transfer(m_oldCap, MIGRATECHUNK, MIGRATECHUNK);
+            if (m_cursor >= m_oldCap){
+                m_oldNumDeleted = m_oldSize;
+            }
+            m_migratorChunks++;
+            lock.unlock();
+            this_thread::yield();
+            lock.lock();
+        }else{
+            m_wake.wait(lock);
+        }
+    }
+}
+
+// helper function, returns a lock on the tables if the migrator thread runs, else an empty lock
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+unique_lock<recursive_mutex> BasicCache<Key, Value, Hash, KeyEqual, Allocator>::guard() const {
+    if (m_background){
+        return unique_lock<recursive_mutex>(m_lock);
+    }
+    return unique_lock<recursive_mutex>();
+}
+
+// helper function, probes a table for the live value with the given key and hash of the key. the control byte
+// fingerprint, the packed bits of the key (if Key is a PackedKey) and then the stored hash are compared first so the
+// value in a slot is only read on a likely match, and the probe stops at the first empty slot. the packed bits tell
+// apart keys with equal hashes, e.g. the many IDs of one search string in a Cache that hashes the key only, which
+// would else all be compared value by value. returns the index of the value or -1 if it is not in the table
+// if freeSlot is not null it is set to the first deleted or empty slot of the probe sequence (-1 if there is none)
+// if probes is not null it is set to the number of slots (groups in POWEROFTWO mode) probed before the search ended
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+long long BasicCache<Key, Value, Hash, KeyEqual, Allocator>::findIndex(bool old, unsigned long long hash, const Key& key,
+                                                      long long* freeSlot, int* probes) const {
+    const Value* table = old ? m_oldTable : m_currentTable;
+    const signed char* ctrl = old ? m_oldCtrl : m_currentCtrl;
+    const unsigned int* hashes = old ? m_oldHashes : m_currentHashes;
+    const unsigned short* packed = old ? m_oldPacked : m_currentPacked;
+    unsigned short bits = packedBits(key, 0);
+    long long cap = old ? m_oldCap : m_currentCap;
+    signed char tag = fingerprint(hash);
+    unsigned int stored = foldHash(hash);
+    long long h = home(hash, old);
+    long long count = 0;
+    long long square = 0; // count * count % cap, kept up to date without a division
+    long long firstFree = -1;
+
+    // POWEROFTWO mode compares a whole group of control bytes at once and stops after the first group with an
+    // empty slot. the start of the group moves by GROUPWIDTH, 2*GROUPWIDTH, ... slots (triangular probing)
+    if (m_policy == POWEROFTWO){
+        long long groups = 1;
+        for (; groups <= cap / GROUPWIDTH; groups++){
+            unsigned int matches = matchMask(ctrl + h, tag);
+            while (matches != 0){
+                long long index = (h + __builtin_ctz(matches)) & (cap - 1);
+                if ((!PACKED || packed[index] == bits) && hashes[index] == stored
+                    && m_equal(keyOf(table[index]), key)){
+                    return index;
+                }
+                matches &= matches - 1;
+            }
+            unsigned int free = freeMask(ctrl + h);
+            if (free != 0 && firstFree == -1){
+                firstFree = (h + __builtin_ctz(free)) & (cap - 1);
+            }
+            if (matchMask(ctrl + h, CTRLEMPTY) != 0){
+                break;
+            }
+            h = (h + groups * GROUPWIDTH) & (cap - 1);
+        }
+        if (freeSlot != nullptr){
+            *freeSlot = firstFree;
+        }
+        if (probes != nullptr){
+            *probes = groups;
+        }
+        return -1;
+    }
+
+    while (ctrl[h] != CTRLEMPTY && count <= cap){
+        if (ctrl[h] == tag && (!PACKED || packed[h] == bits) && hashes[h] == stored
+            && m_equal(keyOf(table[h]), key)){
+            return h;
+        }
+        if (ctrl[h] == CTRLDELETED && firstFree == -1){
+            firstFree = h;
+        }
+        nextProbe(h, square, count, cap);
+    }
+    if (freeSlot != nullptr){
+        *freeSlot = (firstFree == -1 && ctrl[h] == CTRLEMPTY) ? h : firstFree;
+    }
+    if (probes != nullptr){
+        *probes = count + 1;
+    }
+    return -1;
+}
+
+// helper function, probes the current table for the first deleted or empty slot in the probe sequence of hash
+// returns -1 if there is no space
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+long long BasicCache<Key, Value, Hash, KeyEqual, Allocator>::findFree(unsigned long long hash) const {
+    const signed char* ctrl = m_currentCtrl;
+    long long cap = m_currentCap;
+    long long h = home(hash, false);
+    long long count = 0;
+    long long square = 0;
+
+    // POWEROFTWO mode checks a group at a time, see findIndex
+    if (m_policy == POWEROFTWO){
+        for (long long groups = 1; groups <= cap / GROUPWIDTH; groups++){
+            unsigned int free = freeMask(ctrl + h);
+            if (free != 0){
+                return (h + __builtin_ctz(free)) & (cap - 1);
+            }
+            h = (h + groups * GROUPWIDTH) & (cap - 1);
+        }
+        return -1;
+    }
+
+    while (ctrl[h] >= 0 && count <= cap){
+        nextProbe(h, square, count, cap);
+    }
+    if (ctrl[h] < 0){
+        return h;
+    }
+    return -1;
+}
+
+// helper function, returns true if fewer than half of the live slots in the probe sequence of hash in the current
+// table hold the same hash. the others collide with it under this seed only, a new seed moves them apart
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+bool BasicCache<Key, Value, Hash, KeyEqual, Allocator>::spreadable(unsigned long long hash) const {
+    long long cap = m_currentCap;
+    unsigned int stored = foldHash(hash);
+    long long h = home(hash, false);
+    long long live = 0;
+    long long same = 0;
+    if (m_policy == POWEROFTWO){
+        for (long long groups = 1; groups <= cap / GROUPWIDTH; groups++){
+            unsigned int mask = liveMask(m_currentCtrl + h);
+            while (mask != 0){
+                long long index = (h + __builtin_ctz(mask)) & (cap - 1);
+                live++;
+                same += m_currentHashes[index] == stored;
+                mask &= mask - 1;
+            }
+            if (matchMask(m_currentCtrl + h, CTRLEMPTY) != 0){
+                break;
+            }
+            h = (h + groups * GROUPWIDTH) & (cap - 1);
+        }
+        return same * 2 < live;
+    }
+    long long count = 0;
+    long long square = 0;
+    while (m_currentCtrl[h] != CTRLEMPTY && count <= cap){
+        if (m_currentCtrl[h] >= 0){
+            live++;
+            same += m_currentHashes[h] == stored;
+        }
+        nextProbe(h, square, count, cap);
+    }
+    return same * 2 < live;
+}
+
+// helper function, allocates a control byte array for a table of the given capacity with every slot empty
+// GROUPWIDTH extra bytes are left empty at the end so a group can always be loaded from any index below cap
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+signed char* BasicCache<Key, Value, Hash, KeyEqual, Allocator>::newCtrl(long long cap) {
+    signed char* ctrl = allocateArray<signed char>(cap + GROUPWIDTH);
+    for (long long i = 0; i < cap + GROUPWIDTH; i++){
+        ctrl[i] = CTRLEMPTY;
+    }
+    return ctrl;
+}
+
+// helper function, returns uninitialized storage for count objects of type T from the allocator
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+template <class T>
+T* BasicCache<Key, Value, Hash, KeyEqual, Allocator>::allocateArray(long long count) {
+    return static_cast<T*>(m_allocator.allocate(sizeof(T) * count));
+}
+
+// helper function, gives the storage of an array of count objects of type T back to the allocator, nothing for an
+// array that was never allocated (nullptr)
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+template <class T>
+void BasicCache<Key, Value, Hash, KeyEqual, Allocator>::deallocateArray(T* array, long long count) {
+    if (array != nullptr){
+        m_allocator.deallocate(array, sizeof(T) * count);
+    }
+}
+
+// helper function, destroys the slots of a table that were ever used (every slot whose control byte is not empty,
+// live or deleted) and deallocates its values, control bytes, stored hashes and packed bits
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+void BasicCache<Key, Value, Hash, KeyEqual, Allocator>::freeTable(Value* table, signed char* ctrl,
+                                                                  unsigned int* hashes, unsigned short* packed,
+                                                                  long long cap) {
+    for (long long i = 0; i < cap; i++){
+        if (ctrl[i] != CTRLEMPTY){
+            table[i].~Value();
+        }
+    }
+    deallocateArray(table, cap);
+    deallocateArray(ctrl, cap + GROUPWIDTH);
+    deallocateArray(hashes, cap);
+    if (packed != nullptr){
+        deallocateArray(packed, cap);
+    }
+}
+
+// helper function, allocates the packed bits of a table of the given capacity if Key is a PackedKey. they are only
+// read in slots that are live, so they are not initialized
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+unsigned short* BasicCache<Key, Value, Hash, KeyEqual, Allocator>::newPacked(long long cap) {
+    return PACKED ? allocateArray<unsigned short>(cap) : nullptr;
+}
+
+// helper function, moves value into slot index of a table. an empty slot was never constructed and gets the value
+// with placement new, a deleted slot still holds the removed value and gets it by assignment
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+void BasicCache<Key, Value, Hash, KeyEqual, Allocator>::construct(Value* table, signed char* ctrl, long long index,
+                                                                  Value&& value) {
+    if (ctrl[index] == CTRLEMPTY){
+        new (&table[index]) Value(std::move(value));
+    }else{
+        table[index] = std::move(value);
+    }
+}
+
+// helper function, allocates the reference counters of a table of the given capacity from the allocator, all 0
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+unsigned char* BasicCache<Key, Value, Hash, KeyEqual, Allocator>::newRefs(long long cap) {
+    unsigned char* refs = allocateArray<unsigned char>(cap);
+    for (long long i = 0; i < cap; i++){
+        refs[i] = 0;
+    }
+    return refs;
+}
+
+// helper function, allocates the deadlines of a table of the given capacity from the allocator, all 0 (no deadline)
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+long long* BasicCache<Key, Value, Hash, KeyEqual, Allocator>::newDeadlines(long long cap) {
+    long long* deadlines = allocateArray<long long>(cap);
+    for (long long i = 0; i < cap; i++){
+        deadlines[i] = 0;
+    }
+    return deadlines;
+}
+
+// helper function, returns the number of live values in the current and the old table
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+long long BasicCache<Key, Value, Hash, KeyEqual, Allocator>::liveCount() const {
+    long long live = m_currentSize - m_currNumDeleted;
+    if (m_oldTable != nullptr){
+        live += m_oldSize - m_oldNumDeleted;
+    }
+    return live;
+}
+
+// helper function, returns the slot of the value the next eviction removes (CLOCK). the hand goes around the current
+// table from where it stopped last time, counting down the reference counters of the live slots it passes, and stops
+// at the first live slot whose counter is 0. a counter is at most MAXREFERENCE, so the hand goes around at most
+// MAXREFERENCE + 1 times. the hand stays at the victim until it is evicted
+// right after a rehash the current table can be empty while the old one is not, then the victim is the next value the
+// transfer would have moved and old is set to true
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+long long BasicCache<Key, Value, Hash, KeyEqual, Allocator>::victim(bool& old) {
+    old = m_currentSize == m_currNumDeleted;
+    if (old){
+        // the slots skipped are not live, so every slot before the cursor is still transferred
+        while (m_oldCtrl[m_cursor] < 0){
+            m_cursor++;
+        }
+        return m_cursor;
+    }
+    while (m_currentCtrl[m_hand] < 0 || m_currentRefs[m_hand] > 0){
+        if (m_currentCtrl[m_hand] >= 0){
+            m_currentRefs[m_hand]--;
+        }
+        m_hand = m_hand + 1 < m_currentCap ? m_hand + 1 : 0;
+    }
+    return m_hand;
+}
+
+// helper function, evicts the victim and moves the hand (or the cursor) past it
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+void BasicCache<Key, Value, Hash, KeyEqual, Allocator>::evict() {
+    bool old;
+    long long index = victim(old);
+    if (old){
+        setCtrl(m_oldCtrl, m_oldCap, index, CTRLDELETED);
+        m_oldNumDeleted++;
+        m_cursor++;
+    }else{
+        setCtrl(m_currentCtrl, m_currentCap, index, CTRLDELETED);
+        m_currNumDeleted++;
+        m_hand = m_hand + 1 < m_currentCap ? m_hand + 1 : 0;
+    }
+    m_stats.m_evictions++;
+}
+
+// helper function, returns the hash a key is recorded under in the sketch, the stored 32 bits of its hash with seed 0.
+// hash is the hash of the key with the given seed, so the key is only hashed again if the table was reseeded
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+unsigned int BasicCache<Key, Value, Hash, KeyEqual, Allocator>::sketchHash(const Key& key, unsigned long long hash,
+                                                                unsigned long long seed) const {
+    return foldHash(seed == 0 ? hash : seededHash(m_hasher, key, 0, 0));
+}
+
+// helper function, returns true if slot index of the current or old table has a deadline that is not after now
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+bool BasicCache<Key, Value, Hash, KeyEqual, Allocator>::expired(bool old, long long index, long long now) const {
+    const long long* deadlines = old ? m_oldDeadlines : m_currentDeadlines;
+    return deadlines != nullptr && deadlines[index] != 0 && deadlines[index] <= now;
+}
+
+// helper function, deletes slot index of the current or old table because its value expired
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+void BasicCache<Key, Value, Hash, KeyEqual, Allocator>::expireSlot(bool old, long long index) {
+    if (old){
+        setCtrl(m_oldCtrl, m_oldCap, index, CTRLDELETED);
+        m_oldNumDeleted++;
+    }else{
+        setCtrl(m_currentCtrl, m_currentCap, index, CTRLDELETED);
+        m_currNumDeleted++;
+    }
+    m_stats.m_expirations++;
+}
+
+// helper function, probes the current or old table like findIndex, but only by hash, and deletes every value with
+// that hash that expired at now. a value with the same hash that did not expire (another key, or the same key
+// inserted again with a later deadline) stays
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+void BasicCache<Key, Value, Hash, KeyEqual, Allocator>::expireHash(bool old, unsigned long long hash, long long now) {
+    const signed char* ctrl = old ? m_oldCtrl : m_currentCtrl;
+    const unsigned int* hashes = old ? m_oldHashes : m_currentHashes;
+    long long cap = old ? m_oldCap : m_currentCap;
+    if ((old ? m_oldDeadlines : m_currentDeadlines) == nullptr){
+        return;
+    }
+    signed char tag = fingerprint(hash);
+    unsigned int stored = foldHash(hash);
+    long long h = home(hash, old);
+
+    if (m_policy == POWEROFTWO){
+        for (long long groups = 1; groups <= cap / GROUPWIDTH; groups++){
+            unsigned int matches = matchMask(ctrl + h, tag);
+            bool last = matchMask(ctrl + h, CTRLEMPTY) != 0;
+            while (matches != 0){
+                long long index = (h + __builtin_ctz(matches)) & (cap - 1);
+                if (hashes[index] == stored && expired(old, index, now)){
+                    expireSlot(old, index);
+                }
+                matches &= matches - 1;
+            }
+            if (last){
+                break;
+            }
+            h = (h + groups * GROUPWIDTH) & (cap - 1);
+        }
+        return;
+    }
+
+    long long count = 0;
+    long long square = 0;
+    while (ctrl[h] != CTRLEMPTY && count <= cap){
+        if (ctrl[h] == tag && hashes[h] == stored && expired(old, h, now)){
+            expireSlot(old, h);
+        }
+        nextProbe(h, square, count, cap);
+    }
+}
+
+// helper function, adds the deadline of a value with the given hash to the timing wheel, which is made on the first
+// one. an empty wheel starts again at the current time
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+void BasicCache<Key, Value, Hash, KeyEqual, Allocator>::schedule(unsigned long long hash, long long deadline) {
+    if (m_wheel == nullptr){
+        m_wheel = new vector<TimerRecord>[WHEELLEVELS * WHEELSIZE];
+    }
+    if (m_wheelCount == 0){
+        m_wheelTime = m_clock();
+    }
+    place(TimerRecord{hash, deadline});
+    m_wheelCount++;
+}
+
+// helper function, puts a record into the lowest level whose buckets reach its deadline from m_wheelTime, into the
+// bucket of its deadline. a deadline that passed goes into the bucket of m_wheelTime, and one past the end of the
+// wheel into the last bucket of the top level, and is put back in when that bucket is reached
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+void BasicCache<Key, Value, Hash, KeyEqual, Allocator>::place(const TimerRecord& record) {
+    long long deadline = record.m_deadline > m_wheelTime ? record.m_deadline : m_wheelTime;
+    long long span = 1LL << (WHEELBITS * WHEELLEVELS);
+    if (deadline - m_wheelTime >= span){
+        deadline = m_wheelTime + span - 1;
+    }
+    int level = 0;
+    while (deadline - m_wheelTime >= 1LL << (WHEELBITS * (level + 1))){
+        level++;
+    }
+    int index = (deadline >> (WHEELBITS * level)) & (WHEELSIZE - 1);
+    m_wheel[level * WHEELSIZE + index].push_back(record);
+    m_wheelMask[level] |= 1ULL << index;
+}
+
+// helper function, makes a new sketch for the eviction limit if the admission policy is on, else deletes it
+template <class Key, class Value, class Hash, class KeyEqual, class Allocator>
+void BasicCache<Key, Value, Hash, KeyEqual, Allocator>::resizeSketch() {
+    delete m_sketch;
+    m_sketch = m_admission && m_evictLimit > 0 ? new FrequencySketch(m_evictLimit) : nullptr;
+}
+#endif
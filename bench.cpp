@@ -0,0 +1,798 @@
+#include "cache.h"
+#include "robinhood.h"
+#include "cuckoo.h"
+#include "sharded.h"
+#include "concurrent.h"
+#include "lockfree.h"
+#include "pooled.h"
+#include "hashers.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <malloc.h>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+// counts heap allocations so every benchmark can report allocations per operation
+static unsigned long long allocations = 0;
+
+void* operator new(size_t size){
+    allocations++;
+    void* ptr = malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr)
+        throw bad_alloc();
+    return ptr;
+}
+void operator delete(void* ptr) noexcept { free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { free(ptr); }
+
+const int NUMKEYS = 64;         // number of distinct search strings used by the benchmarks
+const int NUMPEOPLE = 40000;    // number of people inserted in each benchmark (stays under MAXPRIME/2)
+const int NUMLOOKUPS = 1000000; // number of getPerson calls timed by each benchmark
+
+// same hash function as mytest.cpp
+unsigned int hashCode(const string str) {
+    unsigned int val = 0 ;
+    const unsigned int thirtyThree = 33 ;  // magic number from textbook
+    for ( unsigned int i = 0 ; i < str.length(); i++)
+        val = val * thirtyThree + str[i] ;
+    return val ;
+}
+
+// hashCode and combineHash as a functor for BasicCache, so the compiler can inline both into the probe loop. it also
+// reads the key through the string_view instead of copying it like a hash_fn
+struct InlineHash {
+    unsigned long long operator()(const PersonKey& key) const {
+        unsigned int val = 0;
+        for (unsigned int i = 0; i < key.m_key.length(); i++)
+            val = val * 33 + key.m_key[i];
+        return combineHash(val, key.m_id);
+    }
+};
+
+// simple stopwatch, returns nanoseconds since it was started
+class Timer {
+public:
+    Timer() : m_start(chrono::steady_clock::now()) {}
+    double elapsed() const {
+        return chrono::duration<double, nano>(chrono::steady_clock::now() - m_start).count();
+    }
+private:
+    chrono::steady_clock::time_point m_start;
+};
+
+// builds NUMPEOPLE people spread over numKeys search strings. prefix is prepended to every search string so the
+// benchmarks can use keys that fit in the small string buffer or keys that need a heap allocation
+vector<Person> makePeople(const string& prefix, int numKeys = NUMKEYS){
+    vector<Person> people;
+    for (int i = 0; i < NUMPEOPLE; i++){
+        people.push_back(Person(prefix + to_string(i % numKeys), MINID + (i / numKeys) % (MAXID - MINID + 1)));
+    }
+    return people;
+}
+
+// measures time and heap allocations per getPerson call, half of the lookups are hits and half are misses
+void lookup(const string& name, const string& prefix, POLICY policy = PRIME, int numKeys = NUMKEYS,
+            combine_fn combine = nullptr){
+    vector<Person> people = makePeople(prefix, numKeys);
+    Cache cache(MINPRIME, hashCode, policy, combine);
+    for (size_t i = 0; i < people.size(); i++){
+        cache.insert(people[i]);
+    }
+
+    unsigned long long start = allocations;
+    unsigned long long found = 0;
+    Timer timer;
+    for (int i = 0; i < NUMLOOKUPS; i++){
+        const Person& person = people[i % NUMPEOPLE];
+        // odd iterations look up an ID that was never inserted
+        int id = (i % 2 == 0) ? person.getID() : MAXID + 1;
+        found += cache.getPerson(person.getKey(), id).getID() != 0;
+    }
+    double time = timer.elapsed();
+    cout << name << ": " << time / NUMLOOKUPS << " ns/op, "
+         << double(allocations - start) / NUMLOOKUPS << " allocs/op (" << found << " hits)" << endl;
+}
+
+// like lookup, but with find, which neither copies the key in nor the person out. the keys are copied out of the
+// people before the timer starts, so the only copy left is the one hash_fn takes
+void findLookup(const string& name, const string& prefix){
+    vector<Person> people = makePeople(prefix);
+    vector<string> keys;
+    Cache cache(MINPRIME, hashCode);
+    for (size_t i = 0; i < people.size(); i++){
+        cache.insert(people[i]);
+        keys.push_back(people[i].getKey());
+    }
+
+    unsigned long long start = allocations;
+    unsigned long long found = 0;
+    Timer timer;
+    for (int i = 0; i < NUMLOOKUPS; i++){
+        const Person& person = people[i % NUMPEOPLE];
+        int id = (i % 2 == 0) ? person.getID() : MAXID + 1;
+        found += cache.find(keys[i % NUMPEOPLE], id) != nullptr;
+    }
+    double time = timer.elapsed();
+    cout << name << ": " << time / NUMLOOKUPS << " ns/op, "
+         << double(allocations - start) / NUMLOOKUPS << " allocs/op (" << found << " hits)" << endl;
+}
+
+// measures time and heap allocations per insert of a person that is moved into the cache (the people are built
+// before the timer starts)
+void moveInsert(const string& name, const string& prefix){
+    vector<Person> people = makePeople(prefix);
+    Cache cache(MINPRIME, hashCode);
+
+    unsigned long long start = allocations;
+    Timer timer;
+    for (size_t i = 0; i < people.size(); i++){
+        cache.insert(std::move(people[i]));
+    }
+    double time = timer.elapsed();
+    cout << name << ": " << time / people.size() << " ns/op, "
+         << double(allocations - start) / people.size() << " allocs/op" << endl;
+}
+
+// measures time and heap allocations per insert and remove
+void insertRemove(const string& name, const string& prefix, POLICY policy = PRIME, int numKeys = NUMKEYS,
+                  combine_fn combine = nullptr){
+    vector<Person> people = makePeople(prefix, numKeys);
+    Cache cache(MINPRIME, hashCode, policy, combine);
+
+    unsigned long long start = allocations;
+    Timer timer;
+    for (size_t i = 0; i < people.size(); i++){
+        cache.insert(people[i]);
+    }
+    for (size_t i = 0; i < people.size(); i++){
+        cache.remove(people[i]);
+    }
+    double time = timer.elapsed();
+    cout << name << ": " << time / (2 * people.size()) << " ns/op, "
+         << double(allocations - start) / (2 * people.size()) << " allocs/op" << endl;
+}
+
+// high churn workload for any cache type with the Cache interface: fills the cache with NUMPEOPLE/2 people, then
+// every step removes the oldest person, inserts a new one and looks up a live one. reports time per step
+template <class T>
+void churn(const string& name, T& cache, int numKeys){
+    vector<Person> people;
+    for (int i = 0; i < 8 * NUMPEOPLE; i++){
+        people.push_back(Person("key" + to_string(i % numKeys), MINID + (i / numKeys) % (MAXID - MINID + 1)));
+    }
+    int live = NUMPEOPLE / 2;
+    for (int i = 0; i < live; i++){
+        cache.insert(people[i]);
+    }
+
+    unsigned long long found = 0;
+    int steps = (int)people.size() - live;
+    Timer timer;
+    for (int i = 0; i < steps; i++){
+        cache.remove(people[i]);
+        cache.insert(people[i + live]);
+        const Person& person = people[i + 1 + (i * 7919) % (live - 1)];
+        found += cache.getPerson(person.getKey(), person.getID()).getID() != 0;
+    }
+    double time = timer.elapsed();
+    cout << name << ": " << time / steps << " ns/step (" << found << " hits, deleted ratio "
+         << cache.deletedRatio() << ")" << endl;
+}
+
+// lookups in a cache holding count people with one key each, every lookup is timed on its own so the worst case
+// shows up next to the mean. hit and miss lookups are reported separately
+template <class T>
+void loadLookup(const string& name, T& cache, int count){
+    vector<Person> people;
+    for (int i = 0; i < count; i++){
+        people.push_back(Person("key" + to_string(i), MINID + i % (MAXID - MINID + 1)));
+        cache.insert(people[i]);
+    }
+
+    for (int miss = 0; miss < 2; miss++){
+        vector<double> times;
+        unsigned long long found = 0;
+        for (int i = 0; i < NUMLOOKUPS / 4; i++){
+            const Person& person = people[(i * 7919) % count];
+            int id = miss ? MAXID + 1 : person.getID();
+            Timer timer;
+            found += cache.getPerson(person.getKey(), id).getID() != 0;
+            times.push_back(timer.elapsed());
+        }
+        sort(times.begin(), times.end());
+        double total = 0;
+        for (size_t i = 0; i < times.size(); i++){
+            total += times[i];
+        }
+        cout << name << (miss ? " MISS" : " HIT") << ": " << total / times.size() << " ns/op, p99 "
+             << times[times.size() * 99 / 100] << " ns, max " << times.back() << " ns (" << found << " hits)" << endl;
+    }
+}
+
+// measures time per find call of a Cache (hash called through a function pointer) and of a BasicCache with the same
+// hash as a functor, both with composite hashing. half of the lookups are hits and half are misses
+void functorLookup(const string& name, const string& prefix){
+    vector<Person> people = makePeople(prefix);
+    vector<string> keys;
+    Cache cache(MINPRIME, hashCode, PRIME, combineHash);
+    BasicCache<PersonKey, Person, InlineHash> inlined(MINPRIME);
+    for (size_t i = 0; i < people.size(); i++){
+        cache.insert(people[i]);
+        inlined.insert(people[i]);
+        keys.push_back(people[i].getKey());
+    }
+
+    unsigned long long found = 0;
+    Timer timer;
+    for (int i = 0; i < NUMLOOKUPS; i++){
+        int id = (i % 2 == 0) ? people[i % NUMPEOPLE].getID() : MAXID + 1;
+        found += cache.find(keys[i % NUMPEOPLE], id) != nullptr;
+    }
+    double time = timer.elapsed();
+    unsigned long long start = allocations;
+    Timer timer2;
+    for (int i = 0; i < NUMLOOKUPS; i++){
+        int id = (i % 2 == 0) ? people[i % NUMPEOPLE].getID() : MAXID + 1;
+        found += inlined.find(PersonKey{keys[i % NUMPEOPLE], id}) != nullptr;
+    }
+    double time2 = timer2.elapsed();
+    cout << name << " HASH_FN: " << time / NUMLOOKUPS << " ns/op" << endl;
+    cout << name << " FUNCTOR: " << time2 / NUMLOOKUPS << " ns/op, "
+         << double(allocations - start) / NUMLOOKUPS << " allocs/op (" << found << " hits)" << endl;
+}
+
+// measures the time per call of a hash function on keys of the given length, and the time per find of a Cache with
+// that hash function holding NUMPEOPLE people with such keys
+void hashSpeed(const string& name, hash_fn hash, int length){
+    vector<string> keys;
+    for (int i = 0; i < NUMPEOPLE; i++){
+        string key = to_string(i);
+        keys.push_back(string(length - key.size(), 'k') + key);
+    }
+    unsigned int sum = 0;
+    Timer timer;
+    for (int i = 0; i < NUMLOOKUPS; i++){
+        sum += hash(keys[i % NUMPEOPLE]);
+    }
+    double time = timer.elapsed();
+
+    Cache cache(MINPRIME, hash);
+    for (int i = 0; i < NUMPEOPLE; i++){
+        cache.emplace(keys[i], MINID);
+    }
+    unsigned long long found = 0;
+    Timer timer2;
+    for (int i = 0; i < NUMLOOKUPS; i++){
+        found += cache.find(keys[i % NUMPEOPLE], MINID) != nullptr;
+    }
+    double time2 = timer2.elapsed();
+    cout << name << ": " << time / NUMLOOKUPS << " ns/hash, " << time2 / NUMLOOKUPS << " ns/find ("
+         << found << " hits, " << sum % 2 << ")" << endl;
+}
+
+// hash flooding: inserts keys whose hashes all start probing at the same slot of a table at maximum capacity (which
+// never grows), with and without a probe limit, then looks every key up. reports time per insert and per find
+void flood(const string& name, int probeLimit){
+    vector<string> keys;
+    for (int i = 0; keys.size() < 500; i++){
+        string key = "flood" + to_string(i);
+        if (hashCode(key) % MAXPRIME == 0){
+            keys.push_back(key);
+        }
+    }
+    Cache cache(MAXPRIME, hashCode);
+    cache.setProbeLimit(probeLimit);
+    unsigned long long found = 0;
+    Timer timer;
+    for (size_t i = 0; i < keys.size(); i++){
+        cache.emplace(keys[i], MINID);
+    }
+    double time = timer.elapsed();
+    Timer timer2;
+    for (int j = 0; j < 20; j++){
+        for (size_t i = 0; i < keys.size(); i++){
+            found += cache.find(keys[i], MINID) != nullptr;
+        }
+    }
+    double time2 = timer2.elapsed();
+    cout << name << ": " << time / keys.size() << " ns/insert, " << time2 / (20 * keys.size()) << " ns/find ("
+         << found << " hits)" << endl;
+}
+
+// hot key flooding: inserts 9000 people that share one key into a cache that hashes the key only, with and without a
+// probe limit. every person has the same hash, so a reseed cannot shorten the probe sequence and must not happen.
+// reports time per insert
+void floodHot(const string& name, int probeLimit){
+    Cache cache(MINPRIME, hashCode);
+    cache.setProbeLimit(probeLimit);
+    Timer timer;
+    for (int id = MINID; id <= MAXID; id++){
+        cache.emplace("hot", id);
+    }
+    double time = timer.elapsed();
+    cout << name << ": " << time / (MAXID - MINID + 1) << " ns/insert" << endl;
+}
+
+// growth: inserts NUMPEOPLE people with unique keys into a cache that starts at MINPRIME, timing every insert on its
+// own, with the given migration budget. reports the median, 99th and 99.9th percentile and worst insert
+void growth(const string& name, POLICY policy, int slots, int microseconds){
+    vector<Person> people = makePeople("key", NUMPEOPLE);
+    vector<double> times;
+    times.reserve(people.size());
+    Cache cache(MINPRIME, hashCode, policy);
+    cache.setMigrationBudget(slots, microseconds);
+    for (size_t i = 0; i < people.size(); i++){
+        Timer timer;
+        cache.insert(std::move(people[i]));
+        times.push_back(timer.elapsed());
+    }
+    sort(times.begin(), times.end());
+    cout << name << ": " << times[times.size() / 2] << " ns p50, " << times[times.size() * 99 / 100] << " ns p99, "
+         << times[times.size() * 999 / 1000]
+         << " ns p99.9, " << times.back() << " ns max" << endl;
+}
+
+// growth burst: fills a cache with a tenth of NUMPEOPLE people, then times every insert of the rest on its own while
+// the table grows tenfold, with the transfer done by the inserts or by the migrator thread. the few inserts that
+// transfer 25% of the old table are under 0.1% of them, so p99.99 is reported as well
+void burst(const string& name, POLICY policy, bool background){
+    vector<Person> people = makePeople("key", NUMPEOPLE);
+    vector<double> times;
+    Cache cache(MINPRIME, hashCode, policy);
+    size_t start = people.size() / 10;
+    for (size_t i = 0; i < start; i++){
+        cache.insert(std::move(people[i]));
+    }
+    cache.setBackgroundMigration(background);
+    for (size_t i = start; i < people.size(); i++){
+        Timer timer;
+        cache.insert(std::move(people[i]));
+        times.push_back(timer.elapsed());
+    }
+    cache.setBackgroundMigration(false);
+    sort(times.begin(), times.end());
+    cout << name << ": " << times[times.size() / 2] << " ns p50, " << times[times.size() * 99 / 100] << " ns p99, "
+         << times[times.size() * 999 / 1000] << " ns p99.9, " << times[times.size() * 9999 / 10000] << " ns p99.99, "
+         << times.back() << " ns max" << endl;
+}
+
+// session churn: NUMLOOKUPS inserts of people with a time to live of ttl milliseconds, the same people come back
+// once they expired. times every insert on its own, each does a bounded part of the expiry. reports the percentiles
+// and the number of expired people
+void expiry(const string& name, POLICY policy, int ttl){
+    vector<Person> people = makePeople("key", NUMPEOPLE);
+    vector<double> times;
+    times.reserve(NUMLOOKUPS);
+    Cache cache(MINPRIME, hashCode, policy, combineHash);
+    for (int i = 0; i < NUMLOOKUPS; i++){
+        Timer timer;
+        cache.insert(people[i % NUMPEOPLE], chrono::milliseconds(ttl));
+        times.push_back(timer.elapsed());
+    }
+    sort(times.begin(), times.end());
+    cout << name << ": " << times[times.size() / 2] << " ns p50, " << times[times.size() * 99 / 100] << " ns p99, "
+         << times[times.size() * 999 / 1000] << " ns p99.9, " << times[times.size() * 9999 / 10000] << " ns p99.99, "
+         << times.back() << " ns max, " << cache.stats().m_expirations << " expired" << endl;
+}
+
+// returns the peak resident memory of the process in kilobytes since the last resetPeak, 0 if there is no /proc
+long peakKilobytes(){
+    ifstream status("/proc/self/status");
+    string line;
+    while (getline(status, line)){
+        if (line.compare(0, 6, "VmHWM:") == 0){
+            return atol(line.c_str() + 6);
+        }
+    }
+    return 0;
+}
+void resetPeak(){
+    ofstream("/proc/self/clear_refs") << "5";
+}
+
+// table storage: times building an empty table for NUMPEOPLE people, then growing a cache from MINPRIME to
+// NUMPEOPLE people with unique keys (each rehash hands the table over and allocates the next one), with the given
+// allocator. reports both times and the peak resident memory while growing
+template <class Allocator>
+void storage(const string& name, POLICY policy){
+    vector<Person> people = makePeople("key", NUMPEOPLE);
+    Timer build;
+    {
+        BasicCache<PersonKey, Person, PersonHash, equal_to<PersonKey>, Allocator>
+            empty(2 * NUMPEOPLE, PersonHash{hashCode, nullptr}, policy);
+    }
+    double buildTime = build.elapsed();
+    resetPeak();
+    long before = peakKilobytes();
+    Timer fill;
+    BasicCache<PersonKey, Person, PersonHash, equal_to<PersonKey>, Allocator>
+        cache(MINPRIME, PersonHash{hashCode, nullptr}, policy);
+    for (size_t i = 0; i < people.size(); i++){
+        cache.insert(std::move(people[i]));
+    }
+    double fillTime = fill.elapsed();
+    cout << name << ": " << buildTime / 1000 << " us empty table, " << fillTime / people.size() << " ns per insert, "
+         << peakKilobytes() - before << " KB peak growth" << endl;
+}
+
+// record of the scale benchmark, a 4-byte row ID (the largest run has 200M rows), so a slot takes 9 bytes
+struct Row {
+    unsigned int m_id;
+};
+unsigned int keyOf(const Row& row){
+    return row.m_id;
+}
+// 64-bit hash of a row ID (murmur3 64-bit finalizer), BasicCache stores 32 bits of it and puts the high half into the
+// fingerprint
+struct RowHash {
+    unsigned long long operator()(unsigned int key) const {
+        unsigned long long id = key;
+        id ^= id >> 33;
+        id *= 0xff51afd7ed558ccdULL;
+        id ^= id >> 33;
+        id *= 0xc4ceb9fe1a85ec53ULL;
+        return id ^ (id >> 33);
+    }
+};
+
+// scale: inserts count rows into a table that starts at MINPRIME and grows until it holds all of them, with the given
+// max load and a migration budget of 64 slots per insert (so no insert transfers 25% of a table of millions of slots
+// at once). times every insert on its own, reports ns per insert, the percentiles, the load factor and the peak resident
+// memory per row, then ns per find for hits and for misses in the full table. the insert times go into a histogram of
+// SCALEBUCKET ns buckets instead of a vector, which would take more memory than the table at 200M rows
+const int SCALEBUCKET = 10;
+const int SCALEBUCKETS = 100000;
+void scale(const string& name, POLICY policy, long long count, float maxLoad){
+    vector<long long> histogram(SCALEBUCKETS + 1, 0);
+    double slowest = 0;
+    resetPeak();
+    long before = peakKilobytes();
+    BasicCache<unsigned int, Row, RowHash> cache(MINPRIME, RowHash(), policy);
+    cache.setMaxLoad(maxLoad);
+    cache.setMigrationBudget(64);
+    Timer fill;
+    for (long long i = 0; i < count; i++){
+        Timer timer;
+        cache.insert(Row{(unsigned int)i});
+        double time = timer.elapsed();
+        histogram[min((long long)(time / SCALEBUCKET), (long long)SCALEBUCKETS)]++;
+        slowest = max(slowest, time);
+    }
+    double fillTime = fill.elapsed();
+    long peak = peakKilobytes() - before;
+    // random rows for the finds, the misses are IDs after the last row
+    vector<unsigned int> ids(NUMLOOKUPS);
+    mt19937_64 random(10);
+    for (int i = 0; i < NUMLOOKUPS; i++){
+        ids[i] = random() % count;
+    }
+    int found = 0;
+    Timer hits;
+    for (int i = 0; i < 10 * NUMLOOKUPS; i++){
+        found += cache.find(ids[i % NUMLOOKUPS]) != nullptr;
+    }
+    double hitTime = hits.elapsed();
+    Timer misses;
+    for (int i = 0; i < 10 * NUMLOOKUPS; i++){
+        found += cache.find(ids[i % NUMLOOKUPS] + count) != nullptr;
+    }
+    double missTime = misses.elapsed();
+    // the upper end of the bucket the given fraction of the inserts falls into
+    auto percentile = [&histogram, count](double fraction){
+        long long seen = 0;
+        int bucket = 0;
+        while (bucket < SCALEBUCKETS && (seen += histogram[bucket]) < count * fraction){
+            bucket++;
+        }
+        return (bucket + 1) * SCALEBUCKET;
+    };
+    cout << name << ": " << fillTime / count << " ns per insert, " << percentile(0.5) << " ns p50, "
+         << percentile(0.99) << " ns p99, " << percentile(0.9999) << " ns p99.99, " << slowest
+         << " ns max, load " << cache.lambda() << ", " << peak * 1024.0 / count << " bytes per row peak, "
+         << hitTime / (10 * NUMLOOKUPS) << " ns per hit, " << missTime / (10 * NUMLOOKUPS) << " ns per miss ("
+         << found << " hits)" << endl;
+}
+
+// returns the bytes of heap memory in use, allocated with malloc or mapped for large blocks
+size_t heapBytes(){
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
+// memory per person: fills a cache with NUMPEOPLE people over numKeys search strings (with composite hashing, so
+// both caches probe alike), reports the heap memory the cache holds per person and the time of a getPerson hit
+template <class T>
+void footprint(const string& name, const string& prefix, int numKeys){
+    vector<Person> people = makePeople(prefix, numKeys);
+    size_t before = heapBytes();
+    T cache(MINPRIME, hashCode, PRIME, combineHash);
+    for (size_t i = 0; i < people.size(); i++){
+        cache.insert(people[i]);
+    }
+    size_t bytes = heapBytes() - before;
+    int found = 0;
+    Timer timer;
+    for (int i = 0; i < NUMLOOKUPS; i++){
+        const Person& person = people[i % people.size()];
+        found += cache.getPerson(person.getKey(), person.getID()).getID() != 0;
+    }
+    double time = timer.elapsed();
+    cout << name << ": " << double(bytes) / people.size() << " bytes per person, " << time / NUMLOOKUPS
+         << " ns per getPerson (" << found << " hits)" << endl;
+}
+
+// hit ratio of a bounded cache used cache-aside (getPerson, insert on a miss) on NUMLOOKUPS lookups of a skewed
+// key set, a few keys are looked up much more often than the rest. if scanEvery is not 0, a scan of 1000 people that
+// are looked up only once runs every scanEvery lookups. reports the hit ratio from the counters of the cache
+void hitRatio(const string& name, int limit, int scanEvery, bool admission = false){
+    vector<Person> people = makePeople("key", NUMPEOPLE);
+    Cache cache(MINPRIME, hashCode, PRIME, combineHash);
+    cache.setEvictionLimit(limit);
+    cache.setAdmission(admission);
+    unsigned int random = 2463534242u;
+    int scanned = 0;
+    Timer timer;
+    for (int i = 0; i < NUMLOOKUPS; i++){
+        random ^= random << 13;
+        random ^= random >> 17;
+        random ^= random << 5;
+        // the cube of a uniform number in [0, 1) picks small indexes much more often
+        double uniform = (random >> 8) / double(1 << 24);
+        const Person& person = people[int(uniform * uniform * uniform * (NUMPEOPLE / 2))];
+        if (cache.find(person.getKey(), person.getID()) == nullptr){
+            cache.insert(person);
+        }
+        if (scanEvery > 0 && i % scanEvery == 0){
+            for (int j = 0; j < 1000; j++){
+                const Person& once = people[NUMPEOPLE / 2 + scanned++ % (NUMPEOPLE / 2)];
+                cache.insert(once);
+            }
+        }
+    }
+    double time = timer.elapsed();
+    CacheStats stats = cache.stats();
+    cout << name << ": " << 100.0 * stats.m_hits / (stats.m_hits + stats.m_misses) << "% hits, "
+         << stats.m_evictions << " evictions, " << stats.m_rejections << " rejections, " << time / NUMLOOKUPS << " ns/lookup" << endl;
+}
+
+// Cache behind one global mutex, what a multi-threaded user of Cache had to do before ShardedCache
+class LockedCache {
+public:
+    LockedCache() : m_cache(MINPRIME, hashCode) {}
+    bool insert(Person person){
+        lock_guard<mutex> lock(m_lock);
+        return m_cache.insert(std::move(person));
+    }
+    bool remove(Person person){
+        lock_guard<mutex> lock(m_lock);
+        return m_cache.remove(std::move(person));
+    }
+    Person getPerson(string key, int id){
+        lock_guard<mutex> lock(m_lock);
+        const Person* person = m_cache.find(key, id);
+        return person != nullptr ? *person : Person();
+    }
+private:
+    mutex m_lock;
+    Cache m_cache;
+};
+
+// mixed load on numThreads threads sharing one cache holding NUMPEOPLE/2 people: one in writeEvery operations is an
+// insert or a remove (half of each), the rest are getPerson of random people. reports the throughput of all threads
+// together
+template <class T>
+void scaling(const string& name, T& cache, int numThreads, int writeEvery = 10){
+    const int OPS = 200000; // operations per thread
+    vector<Person> people = makePeople("key", NUMPEOPLE);
+    for (int i = 0; i < NUMPEOPLE; i += 2){
+        cache.insert(people[i]);
+    }
+    vector<thread> threads;
+    vector<unsigned long long> found(numThreads, 0);
+    Timer timer;
+    for (int t = 0; t < numThreads; t++){
+        threads.push_back(thread([&cache, &people, &found, t, writeEvery](){
+            unsigned int random = 2463534242u + t;
+            for (int i = 0; i < OPS; i++){
+                random ^= random << 13;
+                random ^= random >> 17;
+                random ^= random << 5;
+                const Person& person = people[random % NUMPEOPLE];
+                unsigned int kind = (random >> 16) % (2 * writeEvery);
+                if (kind == 0){
+                    cache.insert(person);
+                }else if (kind == 1){
+                    cache.remove(person);
+                }else{
+                    found[t] += cache.getPerson(person.getKey(), person.getID()).getID() != 0;
+                }
+            }
+        }));
+    }
+    for (thread& t : threads){
+        t.join();
+    }
+    double time = timer.elapsed();
+    unsigned long long hits = 0;
+    for (unsigned long long count : found){
+        hits += count;
+    }
+    cout << name << " " << numThreads << " THREADS: " << 1000.0 * OPS * numThreads / time << " Mops/s (" << hits
+         << " hits)" << endl;
+}
+
+int main(int argc, char* argv[]){
+    string which = argc > 1 ? argv[1] : "all";
+    if (which == "all" || which == "alloc"){
+        lookup("LOOKUP SHORT KEYS", "key");
+        lookup("LOOKUP LONG KEYS", string(40, 'k'));
+        insertRemove("INSERT/REMOVE SHORT KEYS", "key");
+        insertRemove("INSERT/REMOVE LONG KEYS", string(40, 'k'));
+        findLookup("FIND SHORT KEYS", "key");
+        findLookup("FIND LONG KEYS", string(40, 'k'));
+        moveInsert("MOVE INSERT LONG KEYS", string(40, 'k'));
+    }
+    if (which == "all" || which == "policy"){
+        // 64 hot keys shared by many IDs, and one key per person
+        lookup("LOOKUP HOT KEYS PRIME", "key", PRIME);
+        lookup("LOOKUP HOT KEYS POWEROFTWO", "key", POWEROFTWO);
+        lookup("LOOKUP UNIQUE KEYS PRIME", "key", PRIME, NUMPEOPLE);
+        lookup("LOOKUP UNIQUE KEYS POWEROFTWO", "key", POWEROFTWO, NUMPEOPLE);
+        insertRemove("INSERT/REMOVE HOT KEYS PRIME", "key", PRIME);
+        insertRemove("INSERT/REMOVE HOT KEYS POWEROFTWO", "key", POWEROFTWO);
+        insertRemove("INSERT/REMOVE UNIQUE KEYS PRIME", "key", PRIME, NUMPEOPLE);
+        insertRemove("INSERT/REMOVE UNIQUE KEYS POWEROFTWO", "key", POWEROFTWO, NUMPEOPLE);
+    }
+    if (which == "all" || which == "composite"){
+        // 64 hot keys shared by many IDs, hashed by key only and by key and ID
+        lookup("LOOKUP HOT KEYS KEY ONLY", "key", PRIME);
+        lookup("LOOKUP HOT KEYS COMPOSITE", "key", PRIME, NUMKEYS, combineHash);
+        lookup("LOOKUP HOT KEYS COMPOSITE POWEROFTWO", "key", POWEROFTWO, NUMKEYS, combineHash);
+        insertRemove("INSERT/REMOVE HOT KEYS KEY ONLY", "key", PRIME);
+        insertRemove("INSERT/REMOVE HOT KEYS COMPOSITE", "key", PRIME, NUMKEYS, combineHash);
+        RobinHoodCache robinHood(MINPRIME, hashCode, combineHash);
+        churn("CHURN HOT KEYS ROBINHOOD COMPOSITE", robinHood, NUMKEYS);
+    }
+    if (which == "all" || which == "functor"){
+        // hash through a function pointer and inlined hash functor
+        functorLookup("FIND SHORT KEYS", "key");
+        functorLookup("FIND LONG KEYS", string(40, 'k'));
+    }
+    if (which == "all" || which == "hash"){
+        // textbook hash of mytest.cpp and the built-in hashers, on 16, 40, 100 and 200 byte keys
+        int lengths[] = {16, 40, 100, 200};
+        for (int length : lengths){
+            hashSpeed("HASHCODE " + to_string(length) + " BYTES", hashCode, length);
+            hashSpeed("FNV1A " + to_string(length) + " BYTES", fnv1aHash, length);
+            hashSpeed("WYHASH " + to_string(length) + " BYTES", wyHash, length);
+        }
+    }
+    if (which == "all" || which == "flood"){
+        // colliding keys without and with reseeding
+        flood("FLOOD NO PROBE LIMIT", 0);
+        flood("FLOOD PROBE LIMIT 32", 32);
+        // one key with every ID, hashed by key only
+        floodHot("FLOOD HOT KEY NO PROBE LIMIT", 0);
+        floodHot("FLOOD HOT KEY PROBE LIMIT 16", 16);
+    }
+    if (which == "all" || which == "growth"){
+        // latency of single inserts while the table grows, with 25% of the old table per insert and with budgets
+        growth("GROWTH 25% PRIME", PRIME, 0, 0);
+        growth("GROWTH 16 SLOTS PRIME", PRIME, 16, 0);
+        growth("GROWTH 1 MICROSECOND PRIME", PRIME, 0, 1);
+        growth("GROWTH 25% POWEROFTWO", POWEROFTWO, 0, 0);
+        growth("GROWTH 16 SLOTS POWEROFTWO", POWEROFTWO, 16, 0);
+        // tenfold growth with and without the migrator thread
+        burst("BURST 10X PRIME", PRIME, false);
+        burst("BURST 10X PRIME MIGRATOR", PRIME, true);
+        burst("BURST 10X POWEROFTWO", POWEROFTWO, false);
+        burst("BURST 10X POWEROFTWO MIGRATOR", POWEROFTWO, true);
+    }
+    if (which == "all" || which == "eviction"){
+        // bounded caches of 1000 and 4000 people, without scans and with a scan every 1000 lookups
+        hitRatio("EVICTION 1000", 1000, 0);
+        hitRatio("EVICTION 1000 SCANS", 1000, 1000);
+        hitRatio("EVICTION 4000", 4000, 0);
+        hitRatio("EVICTION 4000 SCANS", 4000, 1000);
+        // the same with the TinyLFU admission policy
+        hitRatio("EVICTION 1000 TINYLFU", 1000, 0, true);
+        hitRatio("EVICTION 1000 SCANS TINYLFU", 1000, 1000, true);
+        hitRatio("EVICTION 4000 TINYLFU", 4000, 0, true);
+        hitRatio("EVICTION 4000 SCANS TINYLFU", 4000, 1000, true);
+    }
+    if (which == "all" || which == "ttl"){
+        // insert latency while people expire after 5 and 50 milliseconds
+        expiry("TTL 5 MS PRIME", PRIME, 5);
+        expiry("TTL 50 MS PRIME", PRIME, 50);
+        expiry("TTL 5 MS POWEROFTWO", POWEROFTWO, 5);
+        expiry("TTL 50 MS POWEROFTWO", POWEROFTWO, 50);
+    }
+    if (which == "all" || which == "storage"){
+        // table storage from the heap, from a pool and on huge pages
+        storage<HeapAllocator>("STORAGE HEAP PRIME", PRIME);
+        storage<PoolAllocator>("STORAGE POOL PRIME", PRIME);
+        storage<HeapAllocator>("STORAGE HEAP POWEROFTWO", POWEROFTWO);
+        storage<PoolAllocator>("STORAGE POOL POWEROFTWO", POWEROFTWO);
+        storage<HugePageAllocator>("STORAGE HUGE PAGES POWEROFTWO", POWEROFTWO);
+    }
+    if (which == "all" || which == "pool"){
+        // one Person per slot against interned keys, hot and unique keys, short and long
+        footprint<Cache>("POOL HOT SHORT KEYS CACHE", "key", NUMKEYS);
+        footprint<PooledCache>("POOL HOT SHORT KEYS POOLED", "key", NUMKEYS);
+        footprint<Cache>("POOL HOT LONG KEYS CACHE", string(40, 'k'), NUMKEYS);
+        footprint<PooledCache>("POOL HOT LONG KEYS POOLED", string(40, 'k'), NUMKEYS);
+        footprint<Cache>("POOL UNIQUE LONG KEYS CACHE", string(40, 'k'), NUMPEOPLE);
+        footprint<PooledCache>("POOL UNIQUE LONG KEYS POOLED", string(40, 'k'), NUMPEOPLE);
+    }
+    if (which == "scale"){
+        // 10M rows at the default max load of 0.5 and at 0.875, then 110M rows at 0.875 (about 2.6 GB at the peak of
+        // the last growth). only run on its own, not as part of all
+        scale("SCALE 10M PRIME", PRIME, 10000000, 0.5);
+        scale("SCALE 10M POWEROFTWO", POWEROFTWO, 10000000, 0.5);
+        scale("SCALE 10M POWEROFTWO 0.875", POWEROFTWO, 10000000, 0.875);
+        scale("SCALE 200M POWEROFTWO 0.875", POWEROFTWO, 200000000, 0.875);
+    }
+    if (which == "all" || which == "sharded"){
+        // throughput of a mixed load from 1 to 32 threads, Cache behind one mutex and ShardedCache with 64 shards
+        for (int threads = 1; threads <= 32; threads *= 2){
+            LockedCache locked;
+            scaling("GLOBAL MUTEX", locked, threads);
+            ShardedCache sharded(MINPRIME, hashCode, 64);
+            scaling("SHARDED 64", sharded, threads);
+        }
+    }
+    if (which == "all" || which == "concurrent"){
+        // 95% getPerson from 1 to 32 threads, lock free reads against ShardedCache and one global mutex
+        for (int threads = 1; threads <= 32; threads *= 2){
+            LockedCache locked;
+            scaling("READ MOSTLY GLOBAL MUTEX", locked, threads, 20);
+            ShardedCache sharded(MINPRIME, hashCode, 64);
+            scaling("READ MOSTLY SHARDED 64", sharded, threads, 20);
+            ConcurrentCache concurrent(MINPRIME, hashCode, combineHash);
+            scaling("READ MOSTLY LOCK FREE", concurrent, threads, 20);
+        }
+    }
+    if (which == "all" || which == "lockfree"){
+        // write heavy load (50% inserts and removes) from 1 to 32 threads, one global mutex against no locks at all
+        for (int threads = 1; threads <= 32; threads *= 2){
+            LockedCache locked;
+            scaling("WRITE HEAVY GLOBAL MUTEX", locked, threads, 2);
+            ShardedCache sharded(MINPRIME, hashCode, 64);
+            scaling("WRITE HEAVY SHARDED 64", sharded, threads, 2);
+            LockFreeCache lockFree(MINPRIME, hashCode);
+            scaling("WRITE HEAVY LOCK FREE", lockFree, threads, 2);
+        }
+    }
+    if (which == "all" || which == "churn"){
+        // remove + insert + lookup steps on Cache and RobinHoodCache, with unique keys and with 64 hot keys
+        Cache prime(MINPRIME, hashCode);
+        churn("CHURN UNIQUE KEYS CACHE PRIME", prime, 8 * NUMPEOPLE);
+        Cache power(MINPRIME, hashCode, POWEROFTWO);
+        churn("CHURN UNIQUE KEYS CACHE POWEROFTWO", power, 8 * NUMPEOPLE);
+        RobinHoodCache robinHood(MINPRIME, hashCode);
+        churn("CHURN UNIQUE KEYS ROBINHOOD", robinHood, 8 * NUMPEOPLE);
+        Cache prime2(MINPRIME, hashCode);
+        churn("CHURN HOT KEYS CACHE PRIME", prime2, NUMKEYS);
+        Cache power2(MINPRIME, hashCode, POWEROFTWO);
+        churn("CHURN HOT KEYS CACHE POWEROFTWO", power2, NUMKEYS);
+        RobinHoodCache robinHood2(MINPRIME, hashCode);
+        churn("CHURN HOT KEYS ROBINHOOD", robinHood2, NUMKEYS);
+    }
+    if (which == "all" || which == "cuckoo"){
+        // CuckooCache with 32768 slots filled to each load factor, and Cache holding the same people
+        // (Cache rehashes at a load factor of 0.5, so its own load factor stays lower)
+        float loads[] = {0.5, 0.75, 0.9, 0.95};
+        for (float load : loads){
+            int count = int(load * 32768);
+            CuckooCache cuckoo(32768, hashCode);
+            loadLookup("LOAD " + to_string(load).substr(0, 4) + " CUCKOO", cuckoo, count);
+            Cache cache(MINPRIME, hashCode);
+            loadLookup("LOAD " + to_string(load).substr(0, 4) + " CACHE", cache, count);
+        }
+    }
+    return 0;
+}
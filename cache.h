@@ -2,24 +2,48 @@
 #define CACHE_H
 #include <iostream>
 #include <string>
+#include <string_view>
+#include <utility>
 #include "math.h"
+#include "basiccache.h"
 using namespace std;
 class Tester;   // forward declaration, will be used for testing
 class Person;   // forward declaration
 class Cache;    // forward declaration
+class RobinHoodCache;   // forward declaration
+class CuckooCache;  // forward declaration
+struct PersonKey;   // forward declaration
 const int MINID = 1000;
 const int MAXID = 9999;
-const int MINPRIME = 101;   // Min size for hash table
-const int MAXPRIME = 99991; // Max size for hash table
 #define EMPTY Person("",0)
-#define DELETED Person("DELETED")
-#define DELETEDKEY "DELETED"
 typedef unsigned int (*hash_fn)(string); // declaration of hash function
+typedef unsigned long long (*seeded_hash_fn)(string_view, unsigned long long); // hash function that takes a seed
+typedef unsigned long long (*combine_fn)(unsigned int, int); // combines the hash of a key with an ID into one hash
+// default combiner for composite hashing, mixes the hash of a key with an ID (murmur3 64-bit finalizer) so people that
+// share a key get unrelated hashes instead of one long probe chain. the key hash goes into the high and the ID into the
+// low 32 bits of one 64-bit value, and the finalizer makes every bit of the result depend on both. all 64 bits are
+// returned, BasicCache takes its home slot and fingerprint from different halves and the caches that store 32-bit
+// hashes keep the low half
+// defined here so hash functors of a BasicCache can inline it
+inline unsigned long long combineHash(unsigned int keyHash, int id){
+    unsigned long long x = ((unsigned long long)keyHash << 32) | (unsigned int)id;
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
 class Person{
 public:
     friend class Tester;
     friend class Cache;
-    Person(string key="", int id=0){m_key = key; m_id = id;}
+    friend class RobinHoodCache;
+    friend class CuckooCache;
+    friend PersonKey keyOf(const Person& person);
+    Person(string key="", int id=0) : m_key(std::move(key)), m_id(id) {}
+    Person(const Person&) = default;
+    Person(Person&&) noexcept = default;
     string getKey() const {return m_key;}
     int getID() const {return m_id;}
     void setKey(string key){m_key=key;}
@@ -31,6 +55,14 @@ public:
         }
         return *this;
     }
+    // moves the key of rhs instead of copying it
+    const Person& operator=(Person&& rhs) noexcept {
+        if (this != &rhs){
+            m_key.swap(rhs.m_key);
+            m_id = rhs.m_id;
+        }
+        return *this;
+    }
     // Overloaded insertion operator
     friend ostream& operator<<(ostream& sout, const Person &person );
     // Overloaded equality operator
@@ -40,46 +72,74 @@ private:
     int m_id;       // a unique ID number identifying the object
 };
 
-class Cache{
+// key of a Person in a Cache, its search string and ID. the search string is a view, so a PersonKey can be made from
+// a string_view or from the key of a stored Person without copying it
+struct PersonKey{
+    string_view m_key;
+    int m_id;
+};
+inline bool operator==(const PersonKey& lhs, const PersonKey& rhs){
+    return lhs.m_id == rhs.m_id && lhs.m_key == rhs.m_key;
+}
+// returns the ID of a key, BasicCache keeps the IDs of its people in an array next to the control bytes and compares
+// them before it reads a person. IDs are in [MINID-MAXID], so they fit in 16 bits
+inline unsigned short packedOf(const PersonKey& key){
+    return (unsigned short)key.m_id;
+}
+// returns the key of a person, used by BasicCache to compare stored people with a key
+inline PersonKey keyOf(const Person& person){
+    return PersonKey{person.m_key, person.m_id};
+}
+
+// hash of a PersonKey for Cache, calls the hash_fn given to Cache on the search string and the combine_fn (if any) on
+// the result and the ID. hash_fn takes its key by value, so this is the one copy of the key a lookup makes
+// the seed of the table is mixed into the result (see mixSeed), unless Cache was given a seeded_hash_fn, which gets
+// the seed and the search string itself. only then does a reseed change the hash of keys that collide on all 32 bits
+// the hash is 64 bits wide if the seeded_hash_fn or the combine_fn gives 64 bits, a plain hash_fn only gives 32
+struct PersonHash{
+    hash_fn     m_hash;         // hash function
+    combine_fn  m_combine;      // combines the key hash with the ID, nullptr if only the key is hashed
+    seeded_hash_fn m_seeded = nullptr;// seeded hash function, used instead of m_hash if it is not null
+    unsigned long long operator()(const PersonKey& key, unsigned long long seed = 0) const {
+        if (m_seeded != nullptr){
+            unsigned long long hash = m_seeded(key.m_key, seed);
+            return m_combine != nullptr ? m_combine(foldHash(hash), key.m_id) : hash;
+        }
+        unsigned int hash = m_hash(string(key.m_key));
+        return m_combine != nullptr ? mixSeed(m_combine(hash, key.m_id), seed) : mixSeed(hash, seed);
+    }
+};
+
+// BasicCache for people, built once in cache.cpp
+extern template class BasicCache<PersonKey, Person, PersonHash>;
+
+// cache of Person objects hashed with a hash_fn, only people with an ID in [MINID-MAXID] are inserted
+class Cache : public BasicCache<PersonKey, Person, PersonHash>{
 public:
     friend class Tester;
-    Cache(int size, hash_fn hash);
-    ~Cache();
-    // Returns Load factor of the new table
-    float lambda() const;
-    // Returns the ratio of deleted slots in the new table
-    float deletedRatio() const;
+    // if combine is not null, every person is hashed with combine(hash(key), id) instead of hash(key) (composite
+    // hashing, e.g. with combineHash), so people that share a key are spread over the table
+    Cache(int size, hash_fn hash, POLICY policy = PRIME, combine_fn combine = nullptr);
+    // hashes every key with hash(key, seed) and the seed of the table, so a reseed (see setProbeLimit) spreads out
+    // keys whose hashes collide completely under one seed, e.g. keys crafted against an unseeded hash
+    Cache(int size, seeded_hash_fn hash, POLICY policy = PRIME, combine_fn combine = nullptr);
     // insert only happens in the new table
-    bool insert(Person person);
+    bool insert(const Person& person);
+    // moves person into the table instead of copying it
+    bool insert(Person&& person);
+    // inserts person like insert, it expires ttl after the insert (see BasicCache)
+    bool insert(const Person& person, chrono::milliseconds ttl);
+    // builds the person from key and id and moves it into the table
+    bool emplace(string key, int id);
+    // inserts person unless a person with the same key and ID is already stored. returns the stored person and
+    // whether it was inserted, or an empty person and false if the person cannot be inserted
+    pair<Person, bool> insertOrGet(Person person);
     // remove can happen from either table
     bool remove(Person person);
     // find can happen in either table
     Person getPerson(string key, int id) const;
-    void dump() const;
-
-private:
-    hash_fn     m_hash;         // hash function
-
-    Person*     m_currentTable; // hash table
-    int         m_currentCap;   // hash table size (capacity)
-    int         m_currentSize;  // current number of entries
-    // m_currentSize includes deleted entries
-    int         m_currNumDeleted;// number of deleted entries
-
-    Person*     m_oldTable;     // hash table
-    int         m_oldCap;       // hash table size (capacity)
-    int         m_oldSize;      // current number of entries
-    // m_oldSize includes deleted entries
-    int         m_oldNumDeleted;// number of deleted entries
-
-    //private helper functions
-    bool isPrime(int number); // provided helper function to calculate validity of prime number
-    int findNextPrime(int current); // provided helper function to calculate prime number
-    void fillUpTable(); // helper function used to transfer nodes
-    void reHash(); // helper function to perform rehash operation
-    void deleteOld(); // deallocates old table
-    Person findOldCurrent(string, int, Person) const; // used to find person object in old table
-    bool oldSearch(Person); // removes person objects from old table
-    void hashFunctionHelper(int); // quadratic probing helper
+    // like getPerson, but neither the key nor the person is copied. returns a pointer to the person in the table, or
+    // nullptr if it is not found. the pointer is only valid until the next insert or remove
+    const Person* find(string_view key, int id) const;
 };
 #endif
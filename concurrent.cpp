@@ -0,0 +1,320 @@
+#include "concurrent.h"
+
+ConcurrentCache::Entry ConcurrentCache::TOMBSTONE;
+
+// returns the smallest power of two that is at least size, in the range [MINPRIME-MAXPOWER]
+static int powerOfTwo(int size){
+    int cap = 1;
+    while ((cap < size || cap < MINPRIME) && cap < MAXPOWER){
+        cap <<= 1;
+    }
+    return cap;
+}
+
+// ConcurrentCache object constructor, makes the current table with a power of two capacity
+ConcurrentCache::ConcurrentCache(int size, hash_fn hash, combine_fn combine){
+    m_hash = hash;
+    m_combine = combine;
+    m_current.store(makeTable(powerOfTwo(size)));
+    m_old.store(nullptr);
+    m_sequence.store(0);
+    m_cursor = 0;
+    m_oldQuota = 0;
+}
+
+// ConcurrentCache destructor, deallocates the entries of both tables, the tables and everything retired
+ConcurrentCache::~ConcurrentCache(){
+    Table* tables[2] = {m_current.load(), m_old.load()};
+    for (Table* table : tables){
+        if (table == nullptr)
+            continue;
+        for (int i = 0; i < table->m_cap; i++){
+            Entry* entry = table->m_slots[i].load();
+            if (entry != nullptr && entry != &TOMBSTONE)
+                delete entry;
+        }
+        delete [] table->m_slots;
+        delete table;
+    }
+    for (const Retired& retired : m_retired){
+        delete retired.m_entry;
+        if (retired.m_table != nullptr){
+            delete [] retired.m_table->m_slots;
+            delete retired.m_table;
+        }
+    }
+    m_current.store(nullptr);
+    m_old.store(nullptr);
+}
+
+float ConcurrentCache::lambda() const {
+    lock_guard<mutex> lock(m_writeLock);
+    const Table* current = m_current.load();
+    return float(current->m_size) / float(current->m_cap);
+}
+
+// inserts object into the current table if it is not already in either table. transfers part of the old table after
+// every insertion and rehashes if lambda > 0.5
+bool ConcurrentCache::insert(Person person){
+    if (person.getID() < MINID || person.getID() > MAXID){
+        return false;
+    }
+    lock_guard<mutex> lock(m_writeLock);
+    // the writer is the only thread that changes the tables, so it reads them with relaxed loads
+    Table* current = m_current.load(memory_order_relaxed);
+    Table* old = m_old.load(memory_order_relaxed);
+    int live = current->m_size - current->m_numDeleted + (old != nullptr ? old->m_size - old->m_numDeleted : 0);
+    if (live >= MAXPRIME/2){
+        return false;
+    }
+    PersonKey key = keyOf(person);
+    unsigned int hash = hashOf(key.m_key, key.m_id);
+    if (findIndex(current, hash, key.m_key, key.m_id) != -1
+    || (old != nullptr && findIndex(old, hash, key.m_key, key.m_id) != -1)){
+        return false;
+    }
+
+    Entry* entry = new Entry{std::move(person), hash};
+    if (!place(current, entry)){
+        delete entry;
+        return false;
+    }
+    if (old != nullptr){
+        fillUpTable();
+    }
+    // like Cache, a full table only rehashes without growing if a quarter of its entries are deleted
+    bool canGrow = current->m_cap < MAXPOWER;
+    if (current->m_size > current->m_cap / 2 && m_old.load(memory_order_relaxed) == nullptr
+    && (canGrow || current->m_numDeleted > current->m_size / 4)){
+        reHash();
+    }
+    endWrite();
+    return true;
+}
+
+// removes a person object from whichever table it is in. its slot points to TOMBSTONE and the entry is retired
+bool ConcurrentCache::remove(Person person){
+    lock_guard<mutex> lock(m_writeLock);
+    bool removed = false;
+    PersonKey key = keyOf(person);
+    unsigned int hash = hashOf(key.m_key, key.m_id);
+    Table* tables[2] = {m_current.load(memory_order_relaxed), m_old.load(memory_order_relaxed)};
+    for (Table* table : tables){
+        if (table == nullptr)
+            continue;
+        int h = findIndex(table, hash, key.m_key, key.m_id);
+        if (h != -1){
+            retire(table->m_slots[h].load(memory_order_relaxed), nullptr);
+            table->m_slots[h].store(&TOMBSTONE, memory_order_release);
+            table->m_numDeleted++;
+            removed = true;
+        }
+    }
+    if (tables[1] != nullptr){
+        fillUpTable();
+    }
+    Table* current = tables[0];
+    if (current->m_numDeleted > current->m_size * 0.8 && m_old.load(memory_order_relaxed) == nullptr){
+        reHash();
+    }
+    endWrite();
+    return removed;
+}
+
+// returns the person object if found in either table, else returns an empty person object. takes no lock: the reader
+// is in a critical section (see EpochGuard) so nothing it can reach is freed, searches the old and then the current
+// table and searches again if the tables were swapped in the meantime
+Person ConcurrentCache::getPerson(string key, int id) const {
+    unsigned int hash = hashOf(key, id);
+    EpochGuard guard;
+    while (true){
+        unsigned int sequence = m_sequence.load(memory_order_acquire);
+        if (sequence & 1){
+            // the writer is between the two stores of a table swap
+            continue;
+        }
+        const Table* old = m_old.load(memory_order_acquire);
+        const Table* current = m_current.load(memory_order_acquire);
+        const Entry* entry = old != nullptr ? search(old, hash, key, id) : nullptr;
+        if (entry == nullptr){
+            entry = search(current, hash, key, id);
+        }
+        atomic_thread_fence(memory_order_acquire);
+        if (m_sequence.load(memory_order_relaxed) == sequence){
+            return entry != nullptr ? entry->m_person : Person();
+        }
+    }
+}
+
+void ConcurrentCache::dump() const {
+    lock_guard<mutex> lock(m_writeLock);
+    const Table* tables[2] = {m_current.load(), m_old.load()};
+    for (int i = 0; i < 2; i++){
+        cout << (i == 0 ? "Dump for the current table: " : "Dump for the old table: ") << endl;
+        if (tables[i] == nullptr)
+            continue;
+        for (int j = 0; j < tables[i]->m_cap; j++){
+            cout << "[" << j << "] : ";
+            const Entry* entry = tables[i]->m_slots[j].load();
+            if (entry != nullptr && entry != &TOMBSTONE)
+                cout << entry->m_person;
+            cout << endl;
+        }
+    }
+}
+
+// helper function, returns the hash of a person, the key hash combined with the ID if there is a combiner
+unsigned int ConcurrentCache::hashOf(string_view key, int id) const {
+    unsigned int hash = m_hash(string(key));
+    return m_combine != nullptr ? m_combine(hash, id) : hash;
+}
+
+// helper function, returns the first slot of the probe sequence of hash in a table (fibonacci hashing)
+static inline int homeSlot(unsigned int hash, int cap){
+    return (hash * 0x9E3779B9u) >> (32 - __builtin_ctz(cap));
+}
+
+// helper function, lock free search of a table for the entry of the person with the given key, id and hash. the probe
+// moves 1, 2, 3, ... slots at a time (triangular probing visits every slot) and stops at the first empty slot
+const ConcurrentCache::Entry* ConcurrentCache::search(const Table* table, unsigned int hash, string_view key,
+                                                      int id) const {
+    int h = homeSlot(hash, table->m_cap);
+    for (int i = 1; i <= table->m_cap; i++){
+        const Entry* entry = table->m_slots[h].load(memory_order_acquire);
+        if (entry == nullptr){
+            return nullptr;
+        }
+        if (entry != &TOMBSTONE && entry->m_hash == hash && keyOf(entry->m_person) == PersonKey{key, id}){
+            return entry;
+        }
+        h = (h + i) & (table->m_cap - 1);
+    }
+    return nullptr;
+}
+
+// helper function, writer search of a table, returns the index of the person with the given key, id and hash or -1
+int ConcurrentCache::findIndex(const Table* table, unsigned int hash, string_view key, int id) const {
+    int h = homeSlot(hash, table->m_cap);
+    for (int i = 1; i <= table->m_cap; i++){
+        const Entry* entry = table->m_slots[h].load(memory_order_relaxed);
+        if (entry == nullptr){
+            return -1;
+        }
+        if (entry != &TOMBSTONE && entry->m_hash == hash && keyOf(entry->m_person) == PersonKey{key, id}){
+            return h;
+        }
+        h = (h + i) & (table->m_cap - 1);
+    }
+    return -1;
+}
+
+// helper function, stores entry in the first deleted or empty slot of its probe sequence. the release store makes the
+// whole entry visible to a reader that loads the pointer. returns false if there is no space
+bool ConcurrentCache::place(Table* table, Entry* entry){
+    int h = homeSlot(entry->m_hash, table->m_cap);
+    for (int i = 1; i <= table->m_cap; i++){
+        Entry* slot = table->m_slots[h].load(memory_order_relaxed);
+        if (slot == nullptr || slot == &TOMBSTONE){
+            if (slot == &TOMBSTONE){
+                table->m_numDeleted--;
+            }else{
+                table->m_size++;
+            }
+            table->m_slots[h].store(entry, memory_order_release);
+            return true;
+        }
+        h = (h + i) & (table->m_cap - 1);
+    }
+    return false;
+}
+
+// helper function, allocates a table with cap empty slots
+ConcurrentCache::Table* ConcurrentCache::makeTable(int cap) const {
+    Table* table = new Table;
+    table->m_slots = new atomic<Entry*>[cap];
+    for (int i = 0; i < cap; i++){
+        table->m_slots[i].store(nullptr, memory_order_relaxed);
+    }
+    table->m_cap = cap;
+    table->m_size = 0;
+    table->m_numDeleted = 0;
+    return table;
+}
+
+// helper function, transfers up to m_oldQuota entries from the old table to the current table, from m_cursor on
+// an entry is stored in the current table before its old slot is deleted, so a reader that finds the old slot
+// deleted finds the entry in the current table. the old table is unlinked and retired once it is drained
+void ConcurrentCache::fillUpTable(){
+    Table* current = m_current.load(memory_order_relaxed);
+    Table* old = m_old.load(memory_order_relaxed);
+    int moved = 0;
+    while (moved < m_oldQuota && m_cursor < old->m_cap){
+        Entry* entry = old->m_slots[m_cursor].load(memory_order_relaxed);
+        if (entry != nullptr && entry != &TOMBSTONE){
+            place(current, entry);
+            old->m_slots[m_cursor].store(&TOMBSTONE, memory_order_release);
+            old->m_numDeleted++;
+            moved++;
+        }
+        m_cursor++;
+    }
+    if (m_cursor >= old->m_cap){
+        m_old.store(nullptr, memory_order_release);
+        retire(nullptr, old);
+    }
+}
+
+// helper function, the current table becomes the old table and a new current table with four times as many slots as
+// live entries is made, then the first 25% of the entries are transferred. the new table is allocated before the
+// sequence lock is taken, so readers only retry for the two pointer stores
+void ConcurrentCache::reHash(){
+    Table* current = m_current.load(memory_order_relaxed);
+    int live = current->m_size - current->m_numDeleted;
+    Table* table = makeTable(powerOfTwo(live * 4));
+    m_sequence.fetch_add(1);
+    m_old.store(current);
+    m_current.store(table);
+    m_sequence.fetch_add(1);
+    m_cursor = 0;
+    m_oldQuota = live / 4 > 0 ? live / 4 : 1;
+    fillUpTable();
+}
+
+// helper function, adds an unlinked entry or table to the retired list. its epoch is set by endWrite
+void ConcurrentCache::retire(Entry* entry, Table* table){
+    m_retired.push_back(Retired{0, entry, table});
+}
+
+// helper function, called at the end of every write. if the write retired anything, the global epoch is advanced and
+// becomes the epoch of what it retired: a reader that starts in that epoch or later reads the tables after the
+// unlinking and cannot reach it
+void ConcurrentCache::endWrite(){
+    if (!m_retired.empty() && m_retired.back().m_epoch == 0){
+        unsigned long long epoch = advanceEpoch();
+        for (int i = (int)m_retired.size() - 1; i >= 0 && m_retired[i].m_epoch == 0; i--){
+            m_retired[i].m_epoch = epoch;
+        }
+    }
+    if ((int)m_retired.size() >= RETIREBATCH){
+        reclaim();
+    }
+}
+
+// helper function, frees every retired entry and table whose epoch is not after the epoch of the oldest reader
+void ConcurrentCache::reclaim(){
+    unsigned long long oldest = oldestEpoch();
+    size_t kept = 0;
+    for (size_t i = 0; i < m_retired.size(); i++){
+        const Retired& retired = m_retired[i];
+        if (retired.m_epoch <= oldest){
+            delete retired.m_entry;
+            if (retired.m_table != nullptr){
+                delete [] retired.m_table->m_slots;
+                delete retired.m_table;
+            }
+        }else{
+            m_retired[kept++] = retired;
+        }
+    }
+    m_retired.resize(kept);
+}
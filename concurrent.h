@@ -0,0 +1,80 @@
+#ifndef CONCURRENT_H
+#define CONCURRENT_H
+#include "cache.h"
+#include "epoch.h"
+#include <mutex>
+#include <vector>
+class Tester;           // forward declaration, will be used for testing
+class ConcurrentCache;  // forward declaration
+
+// cache for read-mostly workloads with the same interface as Cache. getPerson never takes a lock and never waits for
+// a writer, writers take a mutex so there is one at a time (like one writer per shard of ShardedCache)
+// every person is an immutable entry that the slots of a table point to, so a reader either sees a whole person or
+// none. rehashing is incremental like in Cache, the writer copies the entry pointers of the old table into the current
+// one over the next operations and a reader searches the old table before the current one, so an entry that is moved
+// while it is searched for is always found in one of them. the two table pointers are only swapped under a sequence
+// lock (odd while they change), a reader that overlaps a swap searches again
+// removed entries and drained tables are freed with epoch based reclamation (see epoch.h): a reader publishes the
+// global epoch while it reads, and the writer only frees what was removed in an epoch no reader can still be in
+class ConcurrentCache{
+public:
+    friend class Tester;
+    // combine works like in Cache, composite hashing of key and ID if it is not null
+    ConcurrentCache(int size, hash_fn hash, combine_fn combine = nullptr);
+    // no other thread may use the cache any more
+    ~ConcurrentCache();
+    // Returns Load factor of the new table
+    float lambda() const;
+    // insert only happens in the new table
+    bool insert(Person person);
+    // remove can happen from either table
+    bool remove(Person person);
+    // lock free, returns a copy of the person or an empty person object
+    Person getPerson(string key, int id) const;
+    void dump() const;
+
+private:
+    // a stored person, never changed once a slot points to it
+    struct Entry{
+        Person m_person;
+        unsigned int m_hash;
+    };
+    // one table, a power of two number of slots. a slot is nullptr if it is empty and TOMBSTONE if it is deleted
+    struct Table{
+        atomic<Entry*>* m_slots;
+        int         m_cap;      // number of slots
+        int         m_size;     // number of used slots, including deleted ones
+        int         m_numDeleted;// number of deleted slots
+    };
+    // an entry or table that was unlinked by the writer and is freed once no reader can reach it
+    struct Retired{
+        unsigned long long m_epoch; // epoch the writer moved to after unlinking it, 0 until then
+        Entry*  m_entry;
+        Table*  m_table;
+    };
+
+    static Entry TOMBSTONE;     // the deleted slots of every table point to it
+
+    hash_fn     m_hash;         // hash function
+    combine_fn  m_combine;      // combines the key hash with the ID, nullptr if only the key is hashed
+    atomic<Table*> m_current;   // hash table
+    atomic<Table*> m_old;       // hash table being drained into m_current, nullptr if there is none
+    atomic<unsigned int> m_sequence;// odd while the writer swaps m_current and m_old
+    int         m_cursor;       // every slot of the old table before m_cursor has been transferred
+    int         m_oldQuota;     // number of entries transferred by each operation while the old table exists
+    mutable mutex m_writeLock;  // serializes the writers
+    vector<Retired> m_retired;  // unlinked entries and tables that are not freed yet
+
+    //private helper functions
+    unsigned int hashOf(string_view, int) const; // hash of a person, key hash mixed with the ID if combining
+    const Entry* search(const Table*, unsigned int, string_view, int) const; // lock free probe of a table
+    int findIndex(const Table*, unsigned int, string_view, int) const; // writer probe of a table, index or -1
+    bool place(Table*, Entry*); // writer insert of an entry into the first free slot of its probe sequence
+    Table* makeTable(int) const; // allocates an empty table
+    void fillUpTable(); // helper function used to transfer nodes
+    void reHash(); // helper function to perform rehash operation
+    void retire(Entry*, Table*); // entry or table unlinked by the current write
+    void endWrite(); // moves to a new epoch if the write retired anything, frees what no reader can reach
+    void reclaim(); // frees the retired entries and tables no reader can reach
+};
+#endif
@@ -0,0 +1,291 @@
+#include "cuckoo.h"
+
+const float CUCKOOLOAD = 0.95; // load factor that triggers a rehash, buckets of 4 slots fill up to about 95%
+
+// returns the fingerprint of a hash stored for each slot, never 0 since 0 marks an empty slot
+static inline unsigned char tagOf(unsigned int hash){
+    unsigned char tag = hash >> 24;
+    return tag != 0 ? tag : 1;
+}
+
+// returns the other bucket of a person with the given hash that is in bucket. the offset only depends on the hash and
+// is never 0, so the two buckets are always different and alternate(alternate(bucket)) == bucket
+static inline int alternate(int bucket, unsigned int hash, int mask){
+    int offset = ((hash * 0x5bd1e995u) >> 16) & mask;
+    return bucket ^ (offset != 0 ? offset : 1);
+}
+
+// CuckooCache object constructor, rounds the size up to a power of two number of slots and makes the current table
+// hashing is always composite, a null combine is replaced with combineHash
+CuckooCache::CuckooCache(int size, hash_fn hash, combine_fn combine){
+    m_hash = hash;
+    m_combine = combine != nullptr ? combine : combineHash;
+    int slots = BUCKETSIZE;
+    while ((slots < size || slots < MINPRIME) && slots < MAXPOWER){
+        slots <<= 1;
+    }
+    makeTable(m_current, slots / BUCKETSIZE);
+    m_old.m_slots = nullptr;
+    m_old.m_tags = nullptr;
+    m_old.m_hashes = nullptr;
+    m_old.m_cap = 0;
+    m_old.m_size = 0;
+    m_oldQuota = 0;
+    m_cursor = 0;
+    m_random = 2463534242u;
+}
+
+// CuckooCache destructor, deallocates memory
+CuckooCache::~CuckooCache(){
+    deleteTable(m_current);
+    deleteTable(m_old);
+    m_hash = nullptr;
+    m_combine = nullptr;
+}
+
+float CuckooCache::lambda() const {
+    return float(m_current.m_size) / float(m_current.m_cap * BUCKETSIZE);
+}
+
+float CuckooCache::deletedRatio() const {
+    return 0;
+}
+
+// inserts object into the cache object if it is not already there. transfers part of the old table after every
+// insertion, and rehashes if lambda > CUCKOOLOAD or the stash has more than STASHSIZE entries
+bool CuckooCache::insert(Person person){
+    // checks if person object is in between MINID and MAXID and if there is room (MAXPRIME case like Cache)
+    if (person.getID() < MINID || person.getID() > MAXID || m_current.m_size + m_old.m_size >= MAXPRIME/2){
+        return false;
+    }
+    // checks if the person object has already been inserted before
+    unsigned int hash = hashOf(person.getKey(), person.getID());
+    if (findIndex(m_current, hash, person.getKey(), person.getID()) != -1
+    || findIndex(m_old, hash, person.getKey(), person.getID()) != -1){
+        return false;
+    }
+
+    place(m_current, person, hash);
+    if (m_old.m_slots != nullptr){
+        fillUpTable(m_oldQuota);
+    }
+    bool full = lambda() > CUCKOOLOAD || (int)m_current.m_stash.size() > STASHSIZE;
+    if (full && m_current.m_cap * BUCKETSIZE < MAXPOWER){
+        reHash();
+    }
+    return true;
+}
+
+// removes a person object from whichever table it is in, the slot simply becomes empty again
+bool CuckooCache::remove(Person person){
+    bool removed = false;
+    unsigned int hash = hashOf(person.getKey(), person.getID());
+    Table* tables[2] = {&m_current, &m_old};
+    for (int i = 0; i < 2 && !removed; i++){
+        Table& table = *tables[i];
+        int h = findIndex(table, hash, person.getKey(), person.getID());
+        if (h != -1){
+            if (h < table.m_cap * BUCKETSIZE){
+                table.m_tags[h] = 0;
+            }else{
+                table.m_stash.erase(table.m_stash.begin() + (h - table.m_cap * BUCKETSIZE));
+            }
+            table.m_size--;
+            removed = true;
+        }
+    }
+    if (m_old.m_slots != nullptr){
+        fillUpTable(m_oldQuota);
+    }
+    return removed;
+}
+
+// returns the person object if found in either table, else returns an empty person object
+Person CuckooCache::getPerson(string key, int id) const {
+    const Person* person = find(key, id);
+    if (person != nullptr){
+        return *person;
+    }
+    return Person();
+}
+
+// returns a pointer to the person object if found in either table, else returns nullptr
+// reads at most two buckets and the stash of each table
+const Person* CuckooCache::find(string_view key, int id) const {
+    unsigned int hash = hashOf(key, id);
+    const Table* tables[2] = {&m_current, &m_old};
+    for (int i = 0; i < 2; i++){
+        const Table& table = *tables[i];
+        int h = findIndex(table, hash, key, id);
+        if (h != -1){
+            if (h < table.m_cap * BUCKETSIZE){
+                return &table.m_slots[h];
+            }
+            return &table.m_stash[h - table.m_cap * BUCKETSIZE].m_person;
+        }
+    }
+    return nullptr;
+}
+
+void CuckooCache::dump() const {
+    const Table* tables[2] = {&m_current, &m_old};
+    for (int i = 0; i < 2; i++){
+        const Table& table = *tables[i];
+        cout << (i == 0 ? "Dump for the current table: " : "Dump for the old table: ") << endl;
+        if (table.m_slots == nullptr)
+            continue;
+        for (int j = 0; j < table.m_cap * BUCKETSIZE; j++) {
+            cout << "[" << j / BUCKETSIZE << "." << j % BUCKETSIZE << "] : ";
+            if (table.m_tags[j] != 0)
+                cout << table.m_slots[j];
+            cout << endl;
+        }
+        for (unsigned int j = 0; j < table.m_stash.size(); j++) {
+            cout << "[stash " << j << "] : " << table.m_stash[j].m_person << endl;
+        }
+    }
+}
+
+// helper function, returns the hash of a person, the hash of its key combined with its ID so people with the same key
+// get different buckets
+unsigned int CuckooCache::hashOf(string_view key, int id) const {
+    return m_combine(m_hash(string(key)), id);
+}
+
+// helper function, returns the index of the person with the given key, id and hash in a table, or -1
+// indexes past the last slot (m_cap * BUCKETSIZE) refer to the stash
+int CuckooCache::findIndex(const Table& table, unsigned int hash, string_view key, int id) const {
+    if (table.m_slots == nullptr){
+        return -1;
+    }
+    unsigned char tag = tagOf(hash);
+    int bucket = hash & (table.m_cap - 1);
+    int buckets[2] = {bucket, alternate(bucket, hash, table.m_cap - 1)};
+    for (int i = 0; i < 2; i++){
+        for (int slot = buckets[i] * BUCKETSIZE; slot < (buckets[i] + 1) * BUCKETSIZE; slot++){
+            if (table.m_tags[slot] == tag && table.m_hashes[slot] == hash && table.m_slots[slot].m_id == id
+            && table.m_slots[slot].m_key == key){
+                return slot;
+            }
+        }
+    }
+    for (unsigned int i = 0; i < table.m_stash.size(); i++){
+        const StashEntry& entry = table.m_stash[i];
+        if (entry.m_hash == hash && entry.m_person.m_id == id && entry.m_person.m_key == key){
+            return table.m_cap * BUCKETSIZE + i;
+        }
+    }
+    return -1;
+}
+
+// helper function, cuckoo insert of a person into a table. if both of its buckets are full, a random entry of one of
+// them is displaced and goes on to its own other bucket, up to MAXKICKS times. the entry left over after that goes to
+// the stash. returns false if the stash now holds more than STASHSIZE entries
+bool CuckooCache::place(Table& table, Person person, unsigned int hash){
+    int mask = table.m_cap - 1;
+    int bucket = hash & mask;
+    for (int kick = 0; kick <= MAXKICKS; kick++){
+        int other = alternate(bucket, hash, mask);
+        int buckets[2] = {bucket, other};
+        for (int i = 0; i < 2; i++){
+            for (int slot = buckets[i] * BUCKETSIZE; slot < (buckets[i] + 1) * BUCKETSIZE; slot++){
+                if (table.m_tags[slot] == 0){
+                    table.m_slots[slot].m_key.swap(person.m_key);
+                    table.m_slots[slot].m_id = person.m_id;
+                    table.m_hashes[slot] = hash;
+                    table.m_tags[slot] = tagOf(hash);
+                    table.m_size++;
+                    return true;
+                }
+            }
+        }
+
+        // both buckets are full, displaces a random entry (xorshift random numbers)
+        m_random ^= m_random << 13;
+        m_random ^= m_random >> 17;
+        m_random ^= m_random << 5;
+        int victim = buckets[m_random % 2];
+        int slot = victim * BUCKETSIZE + (m_random >> 1) % BUCKETSIZE;
+        table.m_slots[slot].m_key.swap(person.m_key);
+        swap(table.m_slots[slot].m_id, person.m_id);
+        swap(table.m_hashes[slot], hash);
+        table.m_tags[slot] = tagOf(table.m_hashes[slot]);
+        // the displaced entry was in victim, so its only other choice is its alternate bucket
+        bucket = alternate(victim, hash, mask);
+    }
+
+    StashEntry entry;
+    entry.m_person = person;
+    entry.m_hash = hash;
+    table.m_stash.push_back(entry);
+    table.m_size++;
+    return (int)table.m_stash.size() <= STASHSIZE;
+}
+
+// helper function, allocates an empty table with the given number of buckets
+void CuckooCache::makeTable(Table& table, int cap){
+    table.m_slots = new Person[cap * BUCKETSIZE];
+    table.m_tags = new unsigned char[cap * BUCKETSIZE]();
+    table.m_hashes = new unsigned int[cap * BUCKETSIZE];
+    table.m_cap = cap;
+    table.m_size = 0;
+    table.m_stash.clear();
+}
+
+// helper function, transfers up to num entries from the old table to the current table, first the slots from
+// m_cursor on and then the stash. deallocates the old table once it is empty
+void CuckooCache::fillUpTable(int num){
+    int moved = 0;
+    int slots = m_old.m_cap * BUCKETSIZE;
+    while (moved < num && m_old.m_size > 0){
+        if (m_cursor < slots){
+            if (m_old.m_tags[m_cursor] != 0){
+                place(m_current, m_old.m_slots[m_cursor], m_old.m_hashes[m_cursor]);
+                m_old.m_tags[m_cursor] = 0;
+                m_old.m_size--;
+                moved++;
+            }
+            m_cursor++;
+        }else{
+            place(m_current, m_old.m_stash.back().m_person, m_old.m_stash.back().m_hash);
+            m_old.m_stash.pop_back();
+            m_old.m_size--;
+            moved++;
+        }
+    }
+    if (m_old.m_slots != nullptr && m_old.m_size == 0){
+        deleteTable(m_old);
+    }
+}
+
+// helper function, the current table becomes the old table and a new current table with about twice as many slots
+// as entries is made, then the first 25% of the entries are transferred. an old table that is still being drained
+// is finished first
+void CuckooCache::reHash(){
+    if (m_old.m_slots != nullptr){
+        fillUpTable(m_old.m_size);
+    }
+    m_old = m_current;
+    m_oldQuota = m_old.m_size / 4 > 0 ? m_old.m_size / 4 : 1;
+    m_cursor = 0;
+
+    int slots = BUCKETSIZE;
+    while ((slots < m_old.m_size * 2 || slots < MINPRIME) && slots < MAXPOWER){
+        slots <<= 1;
+    }
+    makeTable(m_current, slots / BUCKETSIZE);
+    fillUpTable(m_oldQuota);
+}
+
+// helper function, deallocates a table
+void CuckooCache::deleteTable(Table& table){
+    delete [] table.m_slots;
+    delete [] table.m_tags;
+    delete [] table.m_hashes;
+    table.m_slots = nullptr;
+    table.m_tags = nullptr;
+    table.m_hashes = nullptr;
+    table.m_cap = 0;
+    table.m_size = 0;
+    table.m_stash.clear();
+}
@@ -0,0 +1,71 @@
+#ifndef CUCKOO_H
+#define CUCKOO_H
+#include "cache.h"
+#include <vector>
+class Tester;       // forward declaration, will be used for testing
+class CuckooCache;  // forward declaration
+
+const int BUCKETSIZE = 4;   // slots per bucket
+const int STASHSIZE = 4;    // entries the stash holds before the table has to grow
+const int MAXKICKS = 256;   // displacements tried by an insert before it falls back to the stash
+
+// bucketized cuckoo hash table with the same interface as Cache, so either one can be used for the same workload
+// every person can only be in one of two buckets of BUCKETSIZE slots (or in a small stash), so a lookup reads at most
+// two buckets and the stash of each table, no matter how full the table is. an insert into two full buckets moves
+// entries to their other bucket until a free slot is found. rehashing is incremental like in Cache, while the old
+// table is drained a lookup checks both tables
+// hashing is always composite (see Cache), the buckets of a person come from the hash of its key combined with its ID,
+// because two buckets cannot hold the many IDs that share one key. a null combine means combineHash
+class CuckooCache{
+public:
+    friend class Tester;
+    CuckooCache(int size, hash_fn hash, combine_fn combine = combineHash);
+    ~CuckooCache();
+    // Returns Load factor of the new table
+    float lambda() const;
+    // Returns the ratio of deleted slots in the new table (always 0)
+    float deletedRatio() const;
+    // insert only happens in the new table
+    bool insert(Person person);
+    // remove can happen from either table
+    bool remove(Person person);
+    // find can happen in either table
+    Person getPerson(string key, int id) const;
+    // like getPerson without copying the person, returns nullptr if it is not found (see Cache::find)
+    const Person* find(string_view key, int id) const;
+    void dump() const;
+
+private:
+    // a person that could not be placed in either of its buckets
+    struct StashEntry{
+        Person m_person;
+        unsigned int m_hash;
+    };
+    // one cuckoo table, m_cap buckets of BUCKETSIZE slots each
+    struct Table{
+        Person*         m_slots;    // m_cap * BUCKETSIZE persons
+        unsigned char*  m_tags;     // fingerprint of the person in each slot, 0 for an empty slot
+        unsigned int*   m_hashes;   // hash of the person in each slot
+        int             m_cap;      // number of buckets, a power of two
+        int             m_size;     // number of entries, including the stash
+        vector<StashEntry> m_stash; // entries that did not fit in their buckets
+    };
+
+    hash_fn     m_hash;         // hash function
+    combine_fn  m_combine;      // combines the key hash with the ID
+    Table       m_current;      // hash table
+    Table       m_old;          // hash table being drained into m_current, m_slots is nullptr if there is none
+    int         m_oldQuota;     // number of entries transferred by each operation while the old table exists
+    int         m_cursor;       // every slot of the old table before m_cursor is empty
+    unsigned int m_random;      // state of the random number generator that picks the entries to displace
+
+    //private helper functions
+    unsigned int hashOf(string_view, int) const; // hash of a person, key hash mixed with the ID
+    int findIndex(const Table&, unsigned int, string_view, int) const; // finds a person in a table
+    bool place(Table&, Person, unsigned int); // cuckoo insert into a table
+    void makeTable(Table&, int); // allocates an empty table
+    void fillUpTable(int); // helper function used to transfer nodes
+    void reHash(); // helper function to perform rehash operation
+    void deleteTable(Table&); // deallocates a table
+};
+#endif
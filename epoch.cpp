@@ -0,0 +1,75 @@
+#include "epoch.h"
+#include <climits>
+
+// readerEpochs[i] is the global epoch that the thread with slot i read when it entered its critical section, or 0
+// while it is outside of one. overflowReaders counts the threads without a slot that are in a critical section
+static atomic<unsigned long long> globalEpoch(1);
+static atomic<unsigned long long> readerEpochs[MAXREADERS];
+static atomic<bool> readerUsed[MAXREADERS];
+static atomic<int> overflowReaders(0);
+
+// epoch slot of a thread, claimed by its first critical section and given back when the thread exits. m_index is -1
+// if all MAXREADERS slots are taken. m_depth counts nested guards, only the outermost one publishes an epoch
+struct ReaderSlot{
+    int m_index;
+    int m_depth;
+    ReaderSlot() : m_index(-1), m_depth(0){
+        for (int i = 0; i < MAXREADERS && m_index == -1; i++){
+            bool expected = false;
+            if (readerUsed[i].compare_exchange_strong(expected, true)){
+                m_index = i;
+            }
+        }
+    }
+    ~ReaderSlot(){
+        if (m_index != -1){
+            readerUsed[m_index].store(false);
+        }
+    }
+};
+static thread_local ReaderSlot readerSlot;
+
+// enters a critical section. the epoch has to be visible to the writers before any table is read, hence the fence
+EpochGuard::EpochGuard(){
+    ReaderSlot& slot = readerSlot;
+    if (slot.m_depth++ > 0){
+        return;
+    }
+    if (slot.m_index != -1){
+        readerEpochs[slot.m_index].store(globalEpoch.load());
+    }else{
+        overflowReaders.fetch_add(1);
+    }
+    atomic_thread_fence(memory_order_seq_cst);
+}
+
+// leaves a critical section
+EpochGuard::~EpochGuard(){
+    ReaderSlot& slot = readerSlot;
+    if (--slot.m_depth > 0){
+        return;
+    }
+    if (slot.m_index != -1){
+        readerEpochs[slot.m_index].store(0, memory_order_release);
+    }else{
+        overflowReaders.fetch_sub(1, memory_order_release);
+    }
+}
+
+unsigned long long advanceEpoch(){
+    return globalEpoch.fetch_add(1) + 1;
+}
+
+unsigned long long oldestEpoch(){
+    if (overflowReaders.load() > 0){
+        return 0;
+    }
+    unsigned long long oldest = ULLONG_MAX;
+    for (int i = 0; i < MAXREADERS; i++){
+        unsigned long long epoch = readerEpochs[i].load();
+        if (epoch != 0 && epoch < oldest){
+            oldest = epoch;
+        }
+    }
+    return oldest;
+}
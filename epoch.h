@@ -0,0 +1,26 @@
+#ifndef EPOCH_H
+#define EPOCH_H
+#include <atomic>
+using namespace std;
+
+const int MAXREADERS = 128; // threads that can be in a critical section at the same time with their own epoch slot
+const int RETIREBATCH = 64; // unlinked entries and tables collected before a writer tries to free them
+
+// epoch based reclamation, shared by every lock free cache. a thread is in a critical section while an EpochGuard of
+// it exists, and only follows pointers into a shared table inside one. memory that a writer unlinks is retired with
+// the epoch advanceEpoch() returns after the unlinking, and can be freed once that epoch is not after oldestEpoch():
+// a thread that entered in that epoch or later read the table after the unlinking and cannot reach it
+// every thread gets one of MAXREADERS slots on its first critical section. threads beyond that are only counted,
+// and nothing is freed while one of them is in a critical section
+class EpochGuard{
+public:
+    EpochGuard();
+    ~EpochGuard();
+    EpochGuard(const EpochGuard&) = delete;
+    EpochGuard& operator=(const EpochGuard&) = delete;
+};
+// moves the global epoch on by one and returns the new epoch
+unsigned long long advanceEpoch();
+// returns the oldest epoch a thread in a critical section entered in (ULLONG_MAX if there is none)
+unsigned long long oldestEpoch();
+#endif
@@ -0,0 +1,128 @@
+#ifndef HASHERS_H
+#define HASHERS_H
+#include <cstring>
+#include <string>
+#include <string_view>
+#include "cache.h"
+using namespace std;
+
+// built-in string hash functions. every one of them can be given to a Cache as its hash_fn, e.g.
+// Cache(MINPRIME, wyHash), and the functors below do the same for a BasicCache without the function pointer
+// wyHash: wyhash (final version 4), a 64-bit hash that reads 48 bytes per step for long keys, 16 bytes per step for
+//         medium keys and at most two overlapping reads for keys of up to 16 bytes. the fastest and the one to use for
+//         long keys
+// fnv1aHash: 64-bit FNV-1a, one byte per step. slower on long keys, but simple and with much better low bits than
+//            the textbook val * 33 + c hash
+
+// constants of wyhash, odd 64-bit numbers with half of their bits set
+const unsigned long long WYP0 = 0xa0761d6478bd642fULL;
+const unsigned long long WYP1 = 0xe7037ed1a0b428dbULL;
+const unsigned long long WYP2 = 0x8ebc6af09c88c6e3ULL;
+const unsigned long long WYP3 = 0x589965cc75374cc3ULL;
+
+// returns the low and high 64 bits of a * b xored together, the mixing step of wyhash
+inline unsigned long long wyMix(unsigned long long a, unsigned long long b){
+    unsigned __int128 product = (unsigned __int128)a * b;
+    return (unsigned long long)product ^ (unsigned long long)(product >> 64);
+}
+
+// reads 8 or 4 bytes at p, memcpy avoids unaligned loads and compiles to a single load
+inline unsigned long long wyRead8(const char* p){
+    unsigned long long value;
+    memcpy(&value, p, 8);
+    return value;
+}
+inline unsigned long long wyRead4(const char* p){
+    unsigned int value;
+    memcpy(&value, p, 4);
+    return value;
+}
+
+// returns the 64-bit wyhash of key with the given seed
+inline unsigned long long wyhash(string_view key, unsigned long long seed = 0){
+    const char* p = key.data();
+    size_t length = key.size();
+    seed ^= wyMix(seed ^ WYP0, WYP1);
+    unsigned long long a, b;
+    if (length <= 16){
+        if (length >= 4){
+            // two overlapping reads of 4 bytes at each end cover every byte
+            size_t offset = (length >> 3) << 2;
+            a = (wyRead4(p) << 32) | wyRead4(p + offset);
+            b = (wyRead4(p + length - 4) << 32) | wyRead4(p + length - 4 - offset);
+        }else if (length > 0){
+            a = ((unsigned long long)(unsigned char)p[0] << 16) | ((unsigned long long)(unsigned char)p[length >> 1] << 8)
+                | (unsigned char)p[length - 1];
+            b = 0;
+        }else{
+            a = b = 0;
+        }
+    }else{
+        size_t i = length;
+        if (i > 48){
+            // three independent lanes of 16 bytes each
+            unsigned long long see1 = seed, see2 = seed;
+            do {
+                seed = wyMix(wyRead8(p) ^ WYP1, wyRead8(p + 8) ^ seed);
+                see1 = wyMix(wyRead8(p + 16) ^ WYP2, wyRead8(p + 24) ^ see1);
+                see2 = wyMix(wyRead8(p + 32) ^ WYP3, wyRead8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= see1 ^ see2;
+        }
+        while (i > 16){
+            seed = wyMix(wyRead8(p) ^ WYP1, wyRead8(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        // the last 16 bytes, overlapping bytes that were already read if the length is not a multiple of 16
+        a = wyRead8(p + i - 16);
+        b = wyRead8(p + i - 8);
+    }
+    a ^= WYP1;
+    b ^= seed;
+    unsigned __int128 product = (unsigned __int128)a * b;
+    a = (unsigned long long)product;
+    b = (unsigned long long)(product >> 64);
+    return wyMix(a ^ WYP0 ^ length, b ^ WYP1);
+}
+
+// returns the 64-bit FNV-1a hash of key
+inline unsigned long long fnv1a(string_view key){
+    unsigned long long hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < key.size(); i++){
+        hash ^= (unsigned char)key[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// hash_fn versions for Cache
+inline unsigned int wyHash(string key){
+    return foldHash(wyhash(key));
+}
+inline unsigned int fnv1aHash(string key){
+    return foldHash(fnv1a(key));
+}
+
+// seeded_hash_fn version for Cache, a reseed of the cache changes every bit of the hash
+inline unsigned long long wySeededHash(string_view key, unsigned long long seed){
+    return wyhash(key, seed);
+}
+
+// functor versions for BasicCache. the key is read through a string_view, so it is never copied. both take the seed
+// of a BasicCache, so a reseed changes every bit of the hash instead of only mixing the 32-bit result, and return all
+// 64 bits (BasicCache stores 32 of them and puts the rest into the fingerprint)
+struct WyHash{
+    unsigned long long operator()(string_view key, unsigned long long seed = 0) const {
+        return wyhash(key, seed);
+    }
+};
+// hashes a PersonKey with wyhash, the ID is mixed into the seed so people that share a key get unrelated hashes
+struct WyPersonHash{
+    unsigned long long operator()(const PersonKey& key, unsigned long long seed = 0) const {
+        return wyhash(key.m_key, seed ^ (unsigned long long)key.m_id);
+    }
+};
+#endif
@@ -0,0 +1,413 @@
+#include "lockfree.h"
+
+LockFreeCache::Entry LockFreeCache::KEYDEAD;
+
+// returns the smallest power of two that is at least size, in the range [MINPRIME-MAXPOWER]
+static int powerOfTwo(int size){
+    int cap = 1;
+    while ((cap < size || cap < MINPRIME) && cap < MAXPOWER){
+        cap <<= 1;
+    }
+    return cap;
+}
+
+// returns the first slot of the probe sequence of hash in a table of cap slots (fibonacci hashing)
+static inline int homeSlot(unsigned int hash, int cap){
+    return (hash * 0x9E3779B9u) >> (32 - __builtin_ctz(cap));
+}
+
+// returns whether a state was ever set to live or dead before the slot was frozen or copied
+static inline bool wasSet(int state){
+    return (state & ~(STATEFROZEN | STATECOPIED)) != STATEEMPTY;
+}
+
+// LockFreeCache object constructor, makes the first table with a power of two capacity
+LockFreeCache::LockFreeCache(int size, hash_fn hash, combine_fn combine){
+    m_hash = hash;
+    m_combine = combine;
+    m_top.store(makeTable(powerOfTwo(size)));
+    m_count.store(0);
+    m_retired.store(nullptr);
+}
+
+// LockFreeCache destructor, deallocates the table chain and the retired tables with all their entries
+LockFreeCache::~LockFreeCache(){
+    Table* lists[2] = {m_top.load(), m_retired.load()};
+    for (int i = 0; i < 2; i++){
+        Table* table = lists[i];
+        while (table != nullptr){
+            Table* next = i == 0 ? table->m_next.load() : table->m_retiredNext;
+            freeTable(table);
+            table = next;
+        }
+    }
+    m_top.store(nullptr);
+    m_retired.store(nullptr);
+}
+
+float LockFreeCache::lambda() const {
+    EpochGuard guard;
+    return float(m_count.load()) / float(m_top.load()->m_cap);
+}
+
+// inserts object if it is not already stored. starts in the top table and goes on in the next tables while the
+// table it is in is being copied
+bool LockFreeCache::insert(Person person){
+    // checks if person object is in between MINID and MAXID and if there is room (MAXPRIME case like Cache)
+    if (person.getID() < MINID || person.getID() > MAXID || m_count.load(memory_order_relaxed) >= MAXPRIME/2){
+        return false;
+    }
+    unsigned int hash = hashOf(keyOf(person).m_key, person.getID());
+    EpochGuard guard;
+    Table* table = m_top.load(memory_order_acquire);
+    RESULT result;
+    while ((result = put(table, person, hash, false)) == NEXT){
+        table = table->m_next.load(memory_order_acquire);
+    }
+    if (result == DONE){
+        m_count.fetch_add(1, memory_order_relaxed);
+    }
+    return result == DONE;
+}
+
+// removes a person object if it is stored, its slot becomes a tombstone
+bool LockFreeCache::remove(Person person){
+    PersonKey key = keyOf(person);
+    unsigned int hash = hashOf(key.m_key, key.m_id);
+    EpochGuard guard;
+    Table* table = m_top.load(memory_order_acquire);
+    RESULT result;
+    while ((result = erase(table, key, hash)) == NEXT){
+        table = table->m_next.load(memory_order_acquire);
+    }
+    if (result == DONE){
+        m_count.fetch_sub(1, memory_order_relaxed);
+    }
+    return result == DONE;
+}
+
+// returns the person object if it is stored, else returns an empty person object
+Person LockFreeCache::getPerson(string key, int id) const {
+    unsigned int hash = hashOf(key, id);
+    Person person;
+    EpochGuard guard;
+    Table* table = m_top.load(memory_order_acquire);
+    while (get(table, PersonKey{key, id}, hash, person) == NEXT){
+        table = table->m_next.load(memory_order_acquire);
+    }
+    return person;
+}
+
+void LockFreeCache::dump() const {
+    int number = 0;
+    for (Table* table = m_top.load(); table != nullptr; table = table->m_next.load(), number++){
+        cout << "Dump for table " << number << ": " << endl;
+        for (int i = 0; i < table->m_cap; i++){
+            cout << "[" << i << "] : ";
+            Entry* key = table->m_keys[i].load();
+            int state = table->m_states[i].load();
+            if (key != nullptr && key != &KEYDEAD && (state & ~STATEFROZEN) == STATELIVE)
+                cout << key->m_person;
+            cout << endl;
+        }
+    }
+}
+
+// helper function, returns the hash of a person, the key hash combined with the ID if there is a combiner
+unsigned int LockFreeCache::hashOf(string_view key, int id) const {
+    unsigned int hash = m_hash(string(key));
+    return m_combine != nullptr ? m_combine(hash, id) : hash;
+}
+
+// helper function, inserts person into one table. claims an empty key slot on the way if the person has none yet,
+// then makes its state live. copy is used by copySlot, it only inserts if the state was never set, so a person that
+// was removed from the next table after it was copied there is not brought back by a late copy of the same slot. a
+// copy also ends in a table that is being copied if the state of the person was ever set there: that table already
+// had the person, and its own copy carries the latest state on (a dead person must not come back further down)
+// returns DONE if the person was inserted, NOTDONE if it was already there and NEXT if the table is being copied and
+// the insert has to go on in the next table
+LockFreeCache::RESULT LockFreeCache::put(Table* table, const Person& person, unsigned int hash, bool copy){
+    PersonKey key = keyOf(person);
+    int cap = table->m_cap;
+    int h = homeSlot(hash, cap);
+    Entry* entry = nullptr;
+    int probes = 1;
+    while (true){
+        Entry* slotKey = table->m_keys[h].load(memory_order_acquire);
+        if (slotKey == nullptr){
+            if (entry == nullptr){
+                entry = new Entry{person, hash};
+            }
+            if (table->m_keys[h].compare_exchange_strong(slotKey, entry, memory_order_acq_rel)){
+                slotKey = entry;
+                entry = nullptr;
+                if (table->m_slots.fetch_add(1, memory_order_relaxed) + 1 > cap / 2){
+                    resize(table);
+                }
+                break;
+            }
+            // another thread claimed the slot first, slotKey is its key now
+        }
+        if (slotKey != &KEYDEAD && slotKey->m_hash == hash && keyOf(slotKey->m_person) == key){
+            break;
+        }
+        // the probe ran into a slot that was copied while empty, or too far: the person goes to the next table
+        if (slotKey == &KEYDEAD || probes >= REPROBELIMIT + (cap >> 2)){
+            delete entry;
+            resize(table);
+            helpCopy(table);
+            return NEXT;
+        }
+        h = (h + probes) & (cap - 1);
+        probes++;
+    }
+    delete entry;
+
+    // once a next table exists the slot is copied there first, and the insert is done in the next table
+    if (table->m_next.load(memory_order_acquire) != nullptr){
+        copySlot(table, h);
+        helpCopy(table);
+        return copy && wasSet(table->m_states[h].load(memory_order_acquire)) ? NOTDONE : NEXT;
+    }
+    int state = table->m_states[h].load(memory_order_acquire);
+    while (true){
+        if (state & (STATEFROZEN | STATECOPIED)){
+            copySlot(table, h);
+            helpCopy(table);
+            return copy && wasSet(state) ? NOTDONE : NEXT;
+        }
+        if (state == STATELIVE || (copy && state == STATEDEAD)){
+            return NOTDONE;
+        }
+        if (table->m_states[h].compare_exchange_weak(state, STATELIVE, memory_order_acq_rel)){
+            return DONE;
+        }
+    }
+}
+
+// helper function, removes the person with the given key from one table. returns DONE if it was removed, NOTDONE if
+// it is not stored and NEXT if the remove has to go on in the next table
+LockFreeCache::RESULT LockFreeCache::erase(Table* table, PersonKey key, unsigned int hash){
+    int cap = table->m_cap;
+    int h = homeSlot(hash, cap);
+    int probes = 1;
+    while (true){
+        Entry* slotKey = table->m_keys[h].load(memory_order_acquire);
+        if (slotKey == nullptr){
+            return NOTDONE;
+        }
+        if (slotKey == &KEYDEAD){
+            helpCopy(table);
+            return NEXT;
+        }
+        if (slotKey->m_hash == hash && keyOf(slotKey->m_person) == key){
+            break;
+        }
+        // an insert never claims a key this far, but it may have gone on to the next table
+        if (probes >= REPROBELIMIT + (cap >> 2)){
+            if (table->m_next.load(memory_order_acquire) == nullptr){
+                return NOTDONE;
+            }
+            helpCopy(table);
+            return NEXT;
+        }
+        h = (h + probes) & (cap - 1);
+        probes++;
+    }
+
+    if (table->m_next.load(memory_order_acquire) != nullptr){
+        copySlot(table, h);
+        helpCopy(table);
+        return NEXT;
+    }
+    int state = table->m_states[h].load(memory_order_acquire);
+    while (true){
+        if (state & (STATEFROZEN | STATECOPIED)){
+            copySlot(table, h);
+            helpCopy(table);
+            return NEXT;
+        }
+        if (state != STATELIVE){
+            return NOTDONE;
+        }
+        if (table->m_states[h].compare_exchange_weak(state, STATEDEAD, memory_order_acq_rel)){
+            return DONE;
+        }
+    }
+}
+
+// helper function, looks the person with the given key up in one table and copies it into person. a frozen slot
+// still holds the latest state of the person (nothing happens to it in the next table before the slot is copied), so
+// lookups never have to help with copying. returns DONE if it was found, NOTDONE if it is not stored and NEXT if the
+// lookup has to go on in the next table
+LockFreeCache::RESULT LockFreeCache::get(Table* table, PersonKey key, unsigned int hash, Person& person) const {
+    int cap = table->m_cap;
+    int h = homeSlot(hash, cap);
+    int probes = 1;
+    while (true){
+        const Entry* slotKey = table->m_keys[h].load(memory_order_acquire);
+        if (slotKey == nullptr){
+            return NOTDONE;
+        }
+        if (slotKey == &KEYDEAD){
+            return NEXT;
+        }
+        if (slotKey->m_hash == hash && keyOf(slotKey->m_person) == key){
+            int state = table->m_states[h].load(memory_order_acquire);
+            if (state & STATECOPIED){
+                return NEXT;
+            }
+            if ((state & ~STATEFROZEN) != STATELIVE){
+                return NOTDONE;
+            }
+            person = slotKey->m_person;
+            return DONE;
+        }
+        if (probes >= REPROBELIMIT + (cap >> 2)){
+            return table->m_next.load(memory_order_acquire) != nullptr ? NEXT : NOTDONE;
+        }
+        h = (h + probes) & (cap - 1);
+        probes++;
+    }
+}
+
+// helper function, installs the next table of a table that is full or has too long probe sequences, unless another
+// thread did already. the next table has four times as many slots as there are people, copying leaves the tombstones
+// behind, so a table full of them is replaced by one of the same size
+void LockFreeCache::resize(Table* table){
+    if (table->m_next.load(memory_order_acquire) != nullptr){
+        return;
+    }
+    Table* next = makeTable(powerOfTwo(m_count.load(memory_order_relaxed) * 4));
+    Table* expected = nullptr;
+    if (!table->m_next.compare_exchange_strong(expected, next, memory_order_acq_rel)){
+        freeTable(next);
+    }
+}
+
+// helper function, copies the next MIGRATECHUNK slots of a table that nobody has claimed yet into its next table,
+// then replaces the top table if it is fully copied
+void LockFreeCache::helpCopy(Table* table){
+    if (table->m_copyClaim.load(memory_order_relaxed) < table->m_cap){
+        int start = table->m_copyClaim.fetch_add(MIGRATECHUNK, memory_order_relaxed);
+        for (int i = start; i < start + MIGRATECHUNK && i < table->m_cap; i++){
+            copySlot(table, i);
+        }
+    }
+    promote();
+}
+
+// helper function, copies slot h of a table into its next table. an empty key slot gets KEYDEAD so nothing can be
+// inserted into it any more. otherwise the state is frozen first, a live person is inserted into the next table and
+// the state becomes copied (the state it was frozen in is kept). any number of threads can copy the same slot, the
+// one whose compare and swap finishes it counts it
+void LockFreeCache::copySlot(Table* table, int h){
+    Entry* slotKey = table->m_keys[h].load(memory_order_acquire);
+    while (slotKey == nullptr){
+        if (table->m_keys[h].compare_exchange_weak(slotKey, &KEYDEAD, memory_order_acq_rel)){
+            if (table->m_copyDone.fetch_add(1, memory_order_acq_rel) + 1 == table->m_cap){
+                promote();
+            }
+            return;
+        }
+    }
+    if (slotKey == &KEYDEAD){
+        return;
+    }
+    int state = table->m_states[h].load(memory_order_acquire);
+    while (!(state & (STATEFROZEN | STATECOPIED))){
+        if (table->m_states[h].compare_exchange_weak(state, state | STATEFROZEN, memory_order_acq_rel)){
+            state |= STATEFROZEN;
+        }
+    }
+    if (state & STATECOPIED){
+        return;
+    }
+    if ((state & ~STATEFROZEN) == STATELIVE){
+        copyLive(table->m_next.load(memory_order_acquire), slotKey);
+    }
+    if (table->m_states[h].compare_exchange_strong(state, state | STATECOPIED, memory_order_acq_rel)){
+        if (table->m_copyDone.fetch_add(1, memory_order_acq_rel) + 1 == table->m_cap){
+            promote();
+        }
+    }
+}
+
+// helper function, inserts a live person copied out of a table into its next table. the copy only goes on past a
+// table that is being copied itself if the person never got a state there, a copier that stalls while others copy
+// the same slot, then remove the person and resize again, must not insert it into a table after that
+void LockFreeCache::copyLive(Table* next, const Entry* key){
+    while (put(next, key->m_person, key->m_hash, true) == NEXT){
+        next = next->m_next.load(memory_order_acquire);
+    }
+}
+
+// helper function, replaces the top table by its next table as long as it is fully copied, and retires it
+void LockFreeCache::promote(){
+    Table* top = m_top.load(memory_order_acquire);
+    while (true){
+        Table* next = top->m_next.load(memory_order_acquire);
+        if (next == nullptr || top->m_copyDone.load(memory_order_acquire) < top->m_cap){
+            return;
+        }
+        if (m_top.compare_exchange_strong(top, next, memory_order_acq_rel)){
+            retire(top);
+            top = next;
+        }
+    }
+}
+
+// helper function, allocates a table with cap unclaimed slots
+LockFreeCache::Table* LockFreeCache::makeTable(int cap) const {
+    Table* table = new Table;
+    table->m_keys = new atomic<Entry*>[cap];
+    table->m_states = new atomic<int>[cap];
+    for (int i = 0; i < cap; i++){
+        table->m_keys[i].store(nullptr, memory_order_relaxed);
+        table->m_states[i].store(STATEEMPTY, memory_order_relaxed);
+    }
+    table->m_cap = cap;
+    table->m_slots.store(0, memory_order_relaxed);
+    table->m_next.store(nullptr, memory_order_relaxed);
+    table->m_copyClaim.store(0, memory_order_relaxed);
+    table->m_copyDone.store(0, memory_order_relaxed);
+    table->m_epoch = 0;
+    table->m_retiredNext = nullptr;
+    return table;
+}
+
+// helper function, deallocates a table and the entries it owns
+void LockFreeCache::freeTable(Table* table) const {
+    for (int i = 0; i < table->m_cap; i++){
+        Entry* key = table->m_keys[i].load(memory_order_relaxed);
+        if (key != nullptr && key != &KEYDEAD){
+            delete key;
+        }
+    }
+    delete [] table->m_keys;
+    delete [] table->m_states;
+    delete table;
+}
+
+// helper function, adds a table that is no longer the top table to the retired list (a lock free stack) with the
+// epoch after its replacement, then frees every retired table no thread can reach any more
+void LockFreeCache::retire(Table* table){
+    table->m_epoch = advanceEpoch();
+    table->m_retiredNext = m_retired.load(memory_order_relaxed);
+    while (!m_retired.compare_exchange_weak(table->m_retiredNext, table, memory_order_acq_rel)){
+    }
+
+    Table* list = m_retired.exchange(nullptr, memory_order_acq_rel);
+    unsigned long long oldest = oldestEpoch();
+    while (list != nullptr){
+        Table* next = list->m_retiredNext;
+        if (list->m_epoch <= oldest){
+            freeTable(list);
+        }else{
+            list->m_retiredNext = m_retired.load(memory_order_relaxed);
+            while (!m_retired.compare_exchange_weak(list->m_retiredNext, list, memory_order_acq_rel)){
+            }
+        }
+        list = next;
+    }
+}
@@ -0,0 +1,86 @@
+#ifndef LOCKFREE_H
+#define LOCKFREE_H
+#include "cache.h"
+#include "epoch.h"
+class Tester;       // forward declaration, will be used for testing
+class LockFreeCache;// forward declaration
+
+const int REPROBELIMIT = 10;// probes after which an insert resizes the table, plus a quarter of its capacity
+// states of a slot, the key of a slot is claimed once and never changes, its state says whether the person is stored
+const int STATEEMPTY = 0;   // the key was claimed, but the person was never inserted
+const int STATELIVE = 1;    // the person is stored
+const int STATEDEAD = 2;    // the person was removed (tombstone), a new insert of the same person makes it live again
+const int STATEFROZEN = 4;  // added to the state while the slot is copied to the next table, it cannot change any more
+const int STATECOPIED = 8;  // added to the frozen state once the slot was copied, the person is in the next table
+
+// non-blocking cache for many writers with the same interface as Cache, nothing ever takes a lock (Click's lock free
+// hash table). a person is identified by key and ID like in Cache and a removed person leaves a tombstone
+// the key of a slot is claimed with a compare and swap and never changes afterwards, its state changes with compare
+// and swaps between empty, live and dead. when a table gets full (or an insert probes too far) a larger next table is
+// installed next to it and every operation that runs into it helps to copy it: a slot is frozen, copied into the next
+// table if it is live and marked copied, and operations on a frozen or copied slot go on in the next table. the
+// table that is fully copied is replaced by the next one and retired
+// hashing is always composite by default (see CuckooCache), the probe limit would make many IDs of one key resize the
+// table over and over
+// drained tables are freed with epoch based reclamation (see epoch.h), every operation is a critical section
+class LockFreeCache{
+public:
+    friend class Tester;
+    LockFreeCache(int size, hash_fn hash, combine_fn combine = combineHash);
+    // no other thread may use the cache any more
+    ~LockFreeCache();
+    // Returns the number of people divided by the capacity of the table operations start in
+    float lambda() const;
+    // inserts person if it is not already stored
+    bool insert(Person person);
+    // removes person if it is stored
+    bool remove(Person person);
+    // returns a copy of the person or an empty person object
+    Person getPerson(string key, int id) const;
+    // not thread safe
+    void dump() const;
+
+private:
+    // the key of a slot, an immutable copy of the person owned by the table
+    struct Entry{
+        Person m_person;
+        unsigned int m_hash;
+    };
+    // one table, a power of two number of slots
+    struct Table{
+        atomic<Entry*>* m_keys;     // key of each slot, nullptr until it is claimed, KEYDEAD if copied while empty
+        atomic<int>* m_states;      // state of each slot
+        int         m_cap;          // number of slots
+        atomic<int> m_slots;        // number of claimed keys
+        atomic<Table*> m_next;      // table this one is copied into, nullptr if there is none
+        atomic<int> m_copyClaim;    // first slot not handed out to a helping thread yet
+        atomic<int> m_copyDone;     // number of copied slots
+        unsigned long long m_epoch; // epoch the table was retired in
+        Table*      m_retiredNext;  // next table in the list of retired tables
+    };
+    // result of an operation on one table
+    enum RESULT {DONE, NOTDONE, NEXT};
+
+    static Entry KEYDEAD;       // key of a slot that was still empty when it was copied
+
+    hash_fn     m_hash;         // hash function
+    combine_fn  m_combine;      // combines the key hash with the ID, nullptr if only the key is hashed
+    atomic<Table*> m_top;       // table every operation starts in
+    atomic<int> m_count;        // number of people stored
+    atomic<Table*> m_retired;   // retired tables that are not freed yet
+
+    //private helper functions
+    unsigned int hashOf(string_view, int) const; // hash of a person, key hash mixed with the ID if combining
+    RESULT put(Table*, const Person&, unsigned int, bool); // insert into one table
+    RESULT erase(Table*, PersonKey, unsigned int); // remove from one table
+    RESULT get(Table*, PersonKey, unsigned int, Person&) const; // lookup in one table
+    void resize(Table*); // installs the next table of a full table
+    void helpCopy(Table*); // copies a chunk of a table into its next table
+    void copySlot(Table*, int); // copies one slot into the next table
+    void copyLive(Table*, const Entry*); // inserts a copied live person into the next table
+    void promote(); // replaces fully copied tables at the top by their next tables
+    Table* makeTable(int) const; // allocates an empty table
+    void freeTable(Table*) const; // deallocates a table and its entries
+    void retire(Table*); // adds a replaced table to the retired list, frees what no thread can reach
+};
+#endif
@@ -1,5 +1,14 @@
 #include "cache.h"
+#include "robinhood.h"
+#include "cuckoo.h"
+#include "sharded.h"
+#include "concurrent.h"
+#include "lockfree.h"
+#include "pooled.h"
+#include "hashers.h"
 #include <random>
+#include <set>
+#include <thread>
 #include <vector>
 const int MINSEARCH = 0;
 const int MAXSEARCH = 7;
@@ -90,12 +99,114 @@ class Tester{
     float lamba(int, int); // lamba function reimplemented for tester class
     void removeRehashRetrieve(); // tests cases of remove with rehashing
     int duplicate(const Cache&, Person); // returns number of duplicates if there are any
+    const Person& slotAt(const Cache&, int, bool = false); // person in a slot of the current or old table
     float deletedRatio(int, int); // deletedRatio function reimplemented for tester class
     void insertAndRemove(); // tests cases of insert and remove combined with rehashing
     void constructor(); // tests constructor
+    void deletedKey(); // tests that a key named "DELETED" is treated like any other key
+    void insertOrGet(); // tests insertOrGet and reuse of deleted slots by insert
+    void powerOfTwo(); // tests the POWEROFTWO capacity policy
+    void robinHood(); // tests insert, getPerson and remove of RobinHoodCache
+    bool robinHoodValid(const RobinHoodCache&, bool); // checks the Robin Hood invariants of a table
+    void cuckoo(); // tests insert, getPerson and remove of CuckooCache
+    void compositeHash(); // tests hashing of key and ID together
+    void findAndMove(); // tests find, insert with move semantics and emplace
+    void basicCache(); // tests BasicCache with a record type other than Person
+    void hashers(); // tests the built-in hash functions
+    double chiSquare(hash_fn, const string&, int, bool); // bucket distribution of a hash function
+    void reseed(); // tests reseeding after long probe sequences
+    void migrationBudget(); // tests the migration cursor and budget
+    void backgroundMigration(); // tests the migrator thread
+    void eviction(); // tests the bounded mode with CLOCK eviction and the hit/miss/eviction counters
+    void admission(); // tests the frequency sketch and the TinyLFU admission policy
+    void timeToLive(); // tests lazy expiry and the timing wheel
+    void sharded(); // tests ShardedCache with several threads
+    void concurrentReads(); // tests lock free reads of ConcurrentCache during writes and rehashes
+    void lockFree(); // tests LockFreeCache with many writers against a sequential model
+    void lockFreeCopy(); // tests that removed people stay removed while LockFreeCache copies tables
+    void tableStorage(); // tests lazily constructed slots and the table allocators
+    void keyPool(); // tests the KeyPool and PooledCache against Cache
+    void packedIds(); // tests the packed IDs compared before a person is read
+    void largeTables(); // tests growth past the constructor limits, the max load and 64-bit hashes
+    bool cuckooValid(const CuckooCache&, bool); // checks that every entry of a table is in one of its two buckets
 };
 
 unsigned int hashCode(const string str);
+unsigned long long addID(unsigned int keyHash, int id);
+
+// record type for the BasicCache tests, a word and the number of times it was seen, looked up by the word
+struct Word {
+    string m_text;
+    int m_count;
+};
+const string& keyOf(const Word& word) {
+    return word.m_text;
+}
+// hash functor for words, the same hash as hashCode
+struct WordHash {
+    unsigned int operator()(const string& text) const {
+        unsigned int val = 0;
+        for (unsigned int i = 0; i < text.length(); i++)
+            val = val * 33 + text[i];
+        return val;
+    }
+};
+typedef BasicCache<string, Word, WordHash> WordCache;
+
+// word that counts how many of its kind exist, to see which slots a table constructs
+struct CountedWord {
+    static int s_alive;
+    string m_text;
+    CountedWord(string text = "") : m_text(std::move(text)) {s_alive++;}
+    CountedWord(const CountedWord& rhs) : m_text(rhs.m_text) {s_alive++;}
+    CountedWord(CountedWord&& rhs) noexcept : m_text(std::move(rhs.m_text)) {s_alive++;}
+    CountedWord& operator=(const CountedWord&) = default;
+    CountedWord& operator=(CountedWord&&) = default;
+    ~CountedWord() {s_alive--;}
+};
+int CountedWord::s_alive = 0;
+
+// allocator that counts the bytes it handed out and did not get back, to see which arrays a cache takes from it
+struct CountingAllocator {
+    static long long s_bytes;
+    void* allocate(size_t bytes) {
+        s_bytes += bytes;
+        return HeapAllocator().allocate(bytes);
+    }
+    void deallocate(void* pointer, size_t bytes) {
+        s_bytes -= bytes;
+        HeapAllocator().deallocate(pointer, bytes);
+    }
+};
+long long CountingAllocator::s_bytes = 0;
+
+// compares person keys like equal_to and counts the compares, to see how often a probe reads a person
+struct CountingEqual {
+    static int s_compares;
+    bool operator()(const PersonKey& lhs, const PersonKey& rhs) const {
+        s_compares++;
+        return lhs == rhs;
+    }
+};
+int CountingEqual::s_compares = 0;
+const string& keyOf(const CountedWord& word) {
+    return word.m_text;
+}
+
+// 8-byte record for the large table tests, looked up by its number
+struct Number {
+    unsigned long long m_value;
+};
+unsigned long long keyOf(const Number& number) {
+    return number.m_value;
+}
+// 64-bit hash of a number that puts the number into the high 32 bits, the low 32 bits of every hash are 0
+struct HighHash {
+    unsigned long long operator()(unsigned long long value) const {
+        return value << 32;
+    }
+};
+typedef BasicCache<unsigned long long, Number, HighHash> NumberCache;
 
 int main(){
     Tester tester;
@@ -106,9 +217,37 @@ int main(){
     tester.removeRehashRetrieve();
     tester.insertAndRemove();
     tester.constructor();
+    tester.deletedKey();
+    tester.insertOrGet();
+    tester.powerOfTwo();
+    tester.robinHood();
+    tester.cuckoo();
+    tester.compositeHash();
+    tester.findAndMove();
+    tester.basicCache();
+    tester.hashers();
+    tester.reseed();
+    tester.migrationBudget();
+    tester.backgroundMigration();
+    tester.eviction();
+    tester.admission();
+    tester.timeToLive();
+    tester.sharded();
+    tester.concurrentReads();
+    tester.lockFree();
+    tester.lockFreeCopy();
+    tester.tableStorage();
+    tester.keyPool();
+    tester.packedIds();
+    tester.largeTables();
     return 0;
 }
 
+// combiner for composite hashing tests, simply adds the ID to the hash of the key
+unsigned long long addID(unsigned int keyHash, int id) {
+    return keyHash + id;
+}
+
 // hash function
 unsigned int hashCode(const string str) {
     unsigned int val = 0 ;
@@ -157,8 +296,8 @@ void Tester::insertNormalAndError() {
         int index = -1;
         for (vector<Person>::iterator it = dataList.begin(); it != dataList.end(); it++) {
             for (int i = 0; i < cache.m_currentCap; i++) {
-                if ((*it).getKey() == cache.m_currentTable[i].getKey() &&
-                    (*it).getID() == cache.m_currentTable[i].getID()) {
+                if ((*it).getKey() == slotAt(cache, i).getKey() &&
+                    (*it).getID() == slotAt(cache, i).getID()) {
                     index = i;
                 }
             }
@@ -214,8 +353,8 @@ void Tester::insertNormalAndError() {
         int index = -1;
         for (vector<Person>::iterator it = dataList2.begin(); it != dataList2.end(); it++) {
             for (int i = 0; i < cache2.m_currentCap; i++) {
-                if ((*it).getKey() == cache2.m_currentTable[i].getKey() &&
-                    (*it).getID() == cache2.m_currentTable[i].getID()) {
+                if ((*it).getKey() == slotAt(cache2, i).getKey() &&
+                    (*it).getID() == slotAt(cache2, i).getID()) {
                     index = i;
                 }
             }
@@ -281,8 +420,8 @@ void Tester::insertNormalAndError() {
         int index = -1;
         for (vector<Person>::iterator it = dataList3.begin(); it != dataList3.end(); it++) {
             for (int i = 0; i < cache3.m_currentCap; i++) {
-                if ((*it).getKey() == cache3.m_currentTable[i].getKey() &&
-                    (*it).getID() == cache3.m_currentTable[i].getID()) {
+                if ((*it).getKey() == slotAt(cache3, i).getKey() &&
+                    (*it).getID() == slotAt(cache3, i).getID()) {
                     index = i;
                 }
             }
@@ -305,9 +444,9 @@ void Tester::insertNormalAndError() {
 
 // recreating hash function for testing (verify insertion without rehashing)
 int Tester::hashFunction(const Cache &cache, Person person) {
-    int h = cache.m_hash(person.getKey()) % cache.m_currentCap;
+    int h = cache.m_hasher.m_hash(person.getKey()) % cache.m_currentCap;
     int counter = 0;
-    while (!cache.m_currentTable[h].m_key.empty() && counter <= cache.m_currentCap){
+    while (!slotAt(cache, h).m_key.empty() && counter <= cache.m_currentCap){
         h = (h + (counter * counter)) % cache.m_currentCap;
         counter++;
     }
@@ -318,7 +457,7 @@ int Tester::hashFunction(const Cache &cache, Person person) {
 bool Tester::findDuplicate(const Cache &cache, Person person) {
     int counter = 0;
     for (int i = 0; i < cache.m_currentCap; i++){
-        if (cache.m_currentTable[i].m_key == person.m_key && cache.m_currentTable[i].m_id == person.m_id){
+        if (slotAt(cache, i).m_key == person.m_key && slotAt(cache, i).m_id == person.m_id){
             counter++;
         }
     }
@@ -365,8 +504,8 @@ void Tester::getPerson() {
         int index = -1;
         for (vector<Person>::iterator it = dataList.begin(); it != dataList.end(); it++) {
             for (int i = 0; i < cache.m_currentCap; i++) {
-                if ((*it).getKey() == cache.m_currentTable[i].getKey() &&
-                    (*it).getID() == cache.m_currentTable[i].getID()) {
+                if ((*it).getKey() == slotAt(cache, i).getKey() &&
+                    (*it).getID() == slotAt(cache, i).getID()) {
                     index = i;
                 }
             }
@@ -421,8 +560,8 @@ void Tester::getPerson() {
         int index = -1;
         for (vector<Person>::iterator it = dataList2.begin(); it != dataList2.end(); it++) {
             for (int i = 0; i < cache2.m_currentCap; i++) {
-                if ((*it).getKey() == cache2.m_currentTable[i].getKey() &&
-                    (*it).getID() == cache2.m_currentTable[i].getID()) {
+                if ((*it).getKey() == slotAt(cache2, i).getKey() &&
+                    (*it).getID() == slotAt(cache2, i).getID()) {
                     index = i;
                 }
             }
@@ -478,8 +617,8 @@ void Tester::getPerson() {
         int index = -1;
         for (vector<Person>::iterator it = dataList3.begin(); it != dataList3.end(); it++) {
             for (int i = 0; i < cache3.m_currentCap; i++) {
-                if ((*it).getKey() == cache3.m_currentTable[i].getKey() &&
-                    (*it).getID() == cache3.m_currentTable[i].getID()) {
+                if ((*it).getKey() == slotAt(cache3, i).getKey() &&
+                    (*it).getID() == slotAt(cache3, i).getID()) {
                     index = i;
                 }
             }
@@ -539,8 +678,8 @@ void Tester::removeNormalAndError() {
         int index = -1;
         for (vector<Person>::iterator it = dataList.begin(); it != dataList.end(); it++) {
             for (int i = 0; i < cache.m_currentCap; i++) {
-                if ((*it).getKey() == cache.m_currentTable[i].getKey() &&
-                    (*it).getID() == cache.m_currentTable[i].getID()) {
+                if ((*it).getKey() == slotAt(cache, i).getKey() &&
+                    (*it).getID() == slotAt(cache, i).getID()) {
                     index = i;
                 }
             }
@@ -611,8 +750,8 @@ void Tester::removeNormalAndError() {
         int index = -1;
         for (vector<Person>::iterator it = dataList2.begin(); it != dataList2.end(); it++) {
             for (int i = 0; i < cache2.m_currentCap; i++) {
-                if ((*it).getKey() == cache2.m_currentTable[i].getKey() &&
-                    (*it).getID() == cache2.m_currentTable[i].getID()) {
+                if ((*it).getKey() == slotAt(cache2, i).getKey() &&
+                    (*it).getID() == slotAt(cache2, i).getID()) {
                     index = i;
                 }
             }
@@ -783,7 +922,7 @@ void Tester::insertRehashRetrieve() {
         }
     }
 
-    if (isThere && reHash && cache4.m_oldTable == nullptr && cache4.m_currentSize == (capacity-1)-duplicateNum){
+    if (isThere && reHash && cache4.m_oldTable == nullptr && cache4.m_currentSize == capacity-duplicateNum){
         cout << "INSERT REHASH NORMAL 4 PASSED" << endl;
     } else {
         cout << "INSERT REHASH NORMAL 4 FAILED" << endl;
@@ -819,7 +958,7 @@ void Tester::insertRehashRetrieve() {
     }
 
     // tries to insert duplicate person and checks if there are duplicates in the cache object
-    Person aPerson = cache5.m_oldTable[capacity];
+    Person aPerson = slotAt(cache5, capacity, true);
     cache5.insert(aPerson);
     int duplicates = duplicate(cache5, aPerson);
     fourth = cache5.m_oldSize*0.25-1;
@@ -951,7 +1090,7 @@ int Tester::duplicate(const Cache & cache, Person person) {
     // counts if there are duplicates in the current table
     while(counter < cache.m_currentCap) {
         if (!duplicate) {
-            duplicate = (person == cache.m_currentTable[counter]);
+            duplicate = (person == slotAt(cache, counter));
         }
         counter++;
     }
@@ -959,9 +1098,10 @@ int Tester::duplicate(const Cache & cache, Person person) {
     // if there are not any duplicates in the current table and old table exists, checks if there are duplicates
     // in old table
     if (cache.m_oldTable && !duplicate){
+        counter = 0;
         while(counter < cache.m_oldCap) {
             if (!duplicate) {
-                duplicate = (person == cache.m_oldTable[counter]);
+                duplicate = (person == slotAt(cache, counter, true));
             }
             counter++;
         }
@@ -972,6 +1112,17 @@ int Tester::duplicate(const Cache & cache, Person person) {
     return 0;
 }
 
+// helper function, returns the person in slot index of the current or old table. a slot that was never used holds no
+// person (the table constructs its slots as they are used), an empty person is returned for it
+const Person& Tester::slotAt(const Cache& cache, int index, bool old) {
+    static const Person empty;
+    const signed char* ctrl = old ? cache.m_oldCtrl : cache.m_currentCtrl;
+    if (ctrl[index] == CTRLEMPTY) {
+        return empty;
+    }
+    return old ? cache.m_oldTable[index] : cache.m_currentTable[index];
+}
+
 float Tester::deletedRatio(int deleted, int size) {
     return float(deleted)/float(size);
 }
@@ -1012,12 +1163,12 @@ void Tester::insertAndRemove() {
     Random RndID3(0, 35);
     int index = RndID2.getRandNum();
     int index2 = RndID3.getRandNum();
-    cache.remove(cache.m_currentTable[index]);
-    cache.remove(cache.m_currentTable[index2]);
+    cache.remove(slotAt(cache, index));
+    cache.remove(slotAt(cache, index2));
 
     // using getPerson to check if the people have been successfully removed from the cache object
-    Person test = cache.getPerson(cache.m_currentTable[index].getKey(), cache.m_currentTable[index].getID());
-    Person test2 = cache.getPerson(cache.m_currentTable[index2].getKey(), cache.m_currentTable[index2].getID());
+    Person test = cache.getPerson(slotAt(cache, index).getKey(), slotAt(cache, index).getID());
+    Person test2 = cache.getPerson(slotAt(cache, index2).getKey(), slotAt(cache, index2).getID());
 
 
     if (isThere && reHash && cache.m_oldTable == nullptr && cache.m_currentSize == capacity && test == EMPTY
@@ -1122,8 +1273,8 @@ void Tester::insertAndRemove() {
     // checking if the removal was successful
     Random RndID4(110, 198);
     index = RndID4.getRandNum();
-    cache3.remove(cache3.m_oldTable[index]);
-    Person test3 = cache3.getPerson(cache3.m_oldTable[index].getKey(), cache3.m_oldTable[index].getID());
+    cache3.remove(slotAt(cache3, index, true));
+    Person test3 = cache3.getPerson(slotAt(cache3, index, true).getKey(), slotAt(cache3, index, true).getID());
     int fourth = cache3.m_oldSize*0.25;
 
     if (isThere && reHash && cache3.m_oldTable != nullptr && cache3.m_currentSize == fourth*3
@@ -1165,6 +1316,8 @@ void Tester::insertAndRemove() {
     // performing 2 insert/remove operations which cancel each other out (adding and removing same node)
     // re adding a node again and checking if it has successfully been readded
     // this is so old table can be deallocated
+    // deleted slots are reused by later inserts and transfers, so only one person is left on top of capacity and
+    // fewer deleted slots remain than the two removals created
     int removeAndInsert = 3;
     removed = true;
     Person aPerson(searchStr[RndStr.getRandNum()], RndID.getRandNum());
@@ -1181,8 +1334,8 @@ void Tester::insertAndRemove() {
         removed = false;
     }
 
-    if (isThere && reHash && cache4.m_oldTable == nullptr && cache4.m_currentSize == capacity+removeAndInsert && removed
-    && cache4.m_currNumDeleted == removeAndInsert-1) {
+    if (isThere && reHash && cache4.m_oldTable == nullptr && cache4.m_currentSize-cache4.m_currNumDeleted == capacity+1
+    && removed && cache4.m_currNumDeleted < removeAndInsert-1) {
         cout << "INSERT AND REMOVE 4 PASSED" << endl;
     } else {
         cout << "INSERT AND REMOVE 4 FAILED" << endl;
@@ -1260,3 +1413,1663 @@ void Tester::constructor() {
         cout << "CONSTRUCTOR ERROR 3 PASSED" << endl;
     }
 }
+
+// tests that the slot state is tracked separately from the data, so a person whose key is "DELETED" can be inserted,
+// found and removed, and that removing a person leaves its slot as a deleted slot rather than an empty one
+void Tester::deletedKey() {
+    Cache cache(MINPRIME, hashCode);
+    Person aPerson("DELETED", MINID);
+    Person aPerson2("DELETED", MAXID);
+    bool inserted = cache.insert(aPerson) && cache.insert(aPerson2);
+    bool found = cache.getPerson("DELETED", MINID) == aPerson && cache.getPerson("DELETED", MAXID) == aPerson2;
+
+    // removes the first person, the second one has the same key so it is further along the same probe sequence
+    bool removed = cache.remove(aPerson);
+    bool gone = cache.getPerson("DELETED", MINID) == EMPTY;
+    bool stillThere = cache.getPerson("DELETED", MAXID) == aPerson2;
+
+    if (inserted && found && removed && gone && stillThere && cache.m_currNumDeleted == 1
+    && cache.m_currentSize == 2) {
+        cout << "DELETED KEY PASSED" << endl;
+    } else {
+        cout << "DELETED KEY FAILED" << endl;
+    }
+}
+
+// tests normal and error cases of insertOrGet, and that inserting a removed person again reuses its deleted slot
+void Tester::insertOrGet() {
+    Cache cache(MINPRIME, hashCode);
+    Person aPerson(searchStr[0], MINID);
+    Person aPerson2(searchStr[0], MINID+1);
+
+    // first insert stores the person, the second one returns the stored person without inserting
+    pair<Person, bool> first = cache.insertOrGet(aPerson);
+    pair<Person, bool> second = cache.insertOrGet(aPerson);
+    pair<Person, bool> error = cache.insertOrGet(Person(searchStr[1], MAXID+1));
+    bool normal = first.second && first.first == aPerson && !second.second && second.first == aPerson
+    && !error.second && error.first == EMPTY;
+
+    // removes the first person (same key as the second one) and inserts it again, the deleted slot is reused
+    cache.insertOrGet(aPerson2);
+    cache.remove(aPerson);
+    int size = cache.m_currentSize;
+    pair<Person, bool> third = cache.insertOrGet(aPerson);
+    bool reused = third.second && cache.m_currentSize == size && cache.m_currNumDeleted == 0
+    && cache.getPerson(aPerson.getKey(), aPerson.getID()) == aPerson
+    && cache.getPerson(aPerson2.getKey(), aPerson2.getID()) == aPerson2;
+
+    if (normal && reused) {
+        cout << "INSERT OR GET PASSED" << endl;
+    } else {
+        cout << "INSERT OR GET FAILED" << endl;
+    }
+}
+
+// tests the POWEROFTWO capacity policy, capacities are powers of two and insert/getPerson/remove work through rehashing
+void Tester::powerOfTwo() {
+    // constructor rounds sizes up to a power of two within [MINPRIME-MAXPOWER]
+    Cache cache(MINPRIME, hashCode, POWEROFTWO);
+    Cache cache2(1000000000, hashCode, POWEROFTWO);
+    Cache cache3(200, hashCode, POWEROFTWO);
+    if (cache.m_currentCap == 128 && cache2.m_currentCap == MAXPOWER && cache3.m_currentCap == 256) {
+        cout << "POWER OF TWO CONSTRUCTOR PASSED" << endl;
+    } else {
+        cout << "POWER OF TWO CONSTRUCTOR FAILED" << endl;
+    }
+
+    // inserts enough people to rehash several times, then removes every other one
+    int capacity = 1000;
+    bool isThere = true;
+    bool powerOfTwo = true;
+    vector<Person> dataList;
+    Random RndID(MINID, MAXID);
+    Random RndStr(MINSEARCH, MAXSEARCH);
+    for (int i = 0; i < capacity; i++) {
+        Person dataObj = Person(searchStr[RndStr.getRandNum()], RndID.getRandNum());
+        if (cache.insert(dataObj)) {
+            dataList.push_back(dataObj);
+        }
+        powerOfTwo = powerOfTwo && (cache.m_currentCap & (cache.m_currentCap - 1)) == 0;
+    }
+    for (vector<Person>::iterator it = dataList.begin(); it != dataList.end(); it++){
+        isThere = isThere && (*it == cache.getPerson((*it).getKey(), (*it).getID()));
+    }
+    bool removed = true;
+    for (unsigned int i = 0; i < dataList.size(); i++){
+        if (i % 2 == 0) {
+            cache.remove(dataList[i]);
+            removed = removed && cache.getPerson(dataList[i].getKey(), dataList[i].getID()) == EMPTY;
+        } else {
+            isThere = isThere && cache.getPerson(dataList[i].getKey(), dataList[i].getID()) == dataList[i];
+        }
+    }
+
+    if (isThere && removed && powerOfTwo && cache.m_currentCap > 128) {
+        cout << "POWER OF TWO REHASH PASSED" << endl;
+    } else {
+        cout << "POWER OF TWO REHASH FAILED" << endl;
+    }
+}
+
+// tests RobinHoodCache with the same kind of workload as the Cache tests, including rehashing and removal
+void Tester::robinHood() {
+    // builds RobinHoodCache object using insert, checking the table after every insertion
+    int capacity = 1000;
+    bool isThere = true;
+    bool valid = true;
+    bool reHash = false;
+    vector<Person> dataList;
+    Random RndID(MINID, MAXID);
+    Random RndStr(MINSEARCH, MAXSEARCH);
+    RobinHoodCache cache(MINPRIME, hashCode);
+    for (int i = 0; i < capacity; i++) {
+        Person dataObj = Person(searchStr[RndStr.getRandNum()], RndID.getRandNum());
+        if (cache.insert(dataObj)) {
+            dataList.push_back(dataObj);
+        }
+        reHash = reHash || cache.m_oldTable != nullptr;
+        valid = valid && robinHoodValid(cache, false) && robinHoodValid(cache, true);
+    }
+    for (vector<Person>::iterator it = dataList.begin(); it != dataList.end(); it++){
+        isThere = isThere && (*it == cache.getPerson((*it).getKey(), (*it).getID()));
+    }
+    // duplicates and invalid IDs are not inserted
+    bool error = !cache.insert(dataList.front()) && !cache.insert(Person(searchStr[0], MAXID+1));
+
+    if (isThere && valid && reHash && error && cache.m_currentSize + cache.m_oldSize == (int)dataList.size()) {
+        cout << "ROBIN HOOD INSERT PASSED" << endl;
+    } else {
+        cout << "ROBIN HOOD INSERT FAILED" << endl;
+    }
+
+    // removes every other person, the others are still found and no deleted slots are left behind
+    bool removed = true;
+    for (unsigned int i = 0; i < dataList.size(); i++){
+        if (i % 2 == 0) {
+            removed = removed && cache.remove(dataList[i]);
+            removed = removed && cache.getPerson(dataList[i].getKey(), dataList[i].getID()) == EMPTY;
+            valid = valid && robinHoodValid(cache, false) && robinHoodValid(cache, true);
+        }
+    }
+    for (unsigned int i = 1; i < dataList.size(); i += 2){
+        isThere = isThere && cache.getPerson(dataList[i].getKey(), dataList[i].getID()) == dataList[i];
+    }
+    removed = removed && !cache.remove(dataList.front());
+
+    if (isThere && removed && valid && cache.deletedRatio() == 0
+    && cache.m_currentSize + cache.m_oldSize == (int)dataList.size() / 2) {
+        cout << "ROBIN HOOD REMOVE PASSED" << endl;
+    } else {
+        cout << "ROBIN HOOD REMOVE FAILED" << endl;
+    }
+}
+
+// checks that every entry of the current or old table of a RobinHoodCache is stored at its probe distance from its
+// home slot, that a cluster never has an entry further from home than the one before it plus one, and that the
+// number of entries matches the size
+bool Tester::robinHoodValid(const RobinHoodCache& cache, bool old) {
+    const int* dist = old ? cache.m_oldDist : cache.m_currentDist;
+    const unsigned int* hashes = old ? cache.m_oldHashes : cache.m_currentHashes;
+    const Person* table = old ? cache.m_oldTable : cache.m_currentTable;
+    int cap = old ? cache.m_oldCap : cache.m_currentCap;
+    if (table == nullptr) {
+        return true;
+    }
+    int count = 0;
+    for (int i = 0; i < cap; i++) {
+        if (dist[i] != 0) {
+            count++;
+            int home = (hashes[i] * 0x9E3779B9u) >> (32 - __builtin_ctz(cap));
+            if ((home + dist[i] - 1) % cap != i || hashes[i] != hashCode(table[i].getKey())) {
+                return false;
+            }
+            if (dist[(i + 1) % cap] > dist[i] + 1) {
+                return false;
+            }
+        }
+    }
+    return count == (old ? cache.m_oldSize : cache.m_currentSize);
+}
+
+// tests CuckooCache with the same kind of workload as the Cache tests, including rehashing, removal and a table that
+// is filled to its maximum load factor
+void Tester::cuckoo() {
+    // builds CuckooCache object using insert, checking the table after every insertion
+    int capacity = 1000;
+    bool isThere = true;
+    bool valid = true;
+    bool reHash = false;
+    vector<Person> dataList;
+    Random RndID(MINID, MAXID);
+    Random RndStr(MINSEARCH, MAXSEARCH);
+    CuckooCache cache(MINPRIME, hashCode);
+    for (int i = 0; i < capacity; i++) {
+        Person dataObj = Person(searchStr[RndStr.getRandNum()], RndID.getRandNum());
+        if (cache.insert(dataObj)) {
+            dataList.push_back(dataObj);
+        }
+        reHash = reHash || cache.m_old.m_slots != nullptr;
+        valid = valid && cuckooValid(cache, false) && cuckooValid(cache, true);
+    }
+    for (vector<Person>::iterator it = dataList.begin(); it != dataList.end(); it++){
+        isThere = isThere && (*it == cache.getPerson((*it).getKey(), (*it).getID()));
+    }
+    // duplicates and invalid IDs are not inserted
+    bool error = !cache.insert(dataList.front()) && !cache.insert(Person(searchStr[0], MAXID+1));
+
+    if (isThere && valid && reHash && error && cache.m_current.m_size + cache.m_old.m_size == (int)dataList.size()) {
+        cout << "CUCKOO INSERT PASSED" << endl;
+    } else {
+        cout << "CUCKOO INSERT FAILED" << endl;
+    }
+
+    // removes every other person, the others are still found
+    bool removed = true;
+    for (unsigned int i = 0; i < dataList.size(); i++){
+        if (i % 2 == 0) {
+            removed = removed && cache.remove(dataList[i]);
+            removed = removed && cache.getPerson(dataList[i].getKey(), dataList[i].getID()) == EMPTY;
+            valid = valid && cuckooValid(cache, false) && cuckooValid(cache, true);
+        }
+    }
+    for (unsigned int i = 1; i < dataList.size(); i += 2){
+        isThere = isThere && cache.getPerson(dataList[i].getKey(), dataList[i].getID()) == dataList[i];
+    }
+    removed = removed && !cache.remove(dataList.front());
+
+    if (isThere && removed && valid && cache.m_current.m_size + cache.m_old.m_size == (int)dataList.size() / 2) {
+        cout << "CUCKOO REMOVE PASSED" << endl;
+    } else {
+        cout << "CUCKOO REMOVE FAILED" << endl;
+    }
+
+    // a table can be filled up to a high load factor without growing and without losing anyone
+    CuckooCache full(MAXPOWER / 4, hashCode);
+    int slots = full.m_current.m_cap * BUCKETSIZE;
+    int count = 0;
+    bool inserted = true;
+    while (full.lambda() < 0.9 && inserted) {
+        inserted = full.insert(Person(searchStr[count % (MAXSEARCH+1)], MINID + count / (MAXSEARCH+1)));
+        count++;
+    }
+    isThere = true;
+    for (int i = 0; i < count; i++) {
+        Person person(searchStr[i % (MAXSEARCH+1)], MINID + i / (MAXSEARCH+1));
+        isThere = isThere && full.getPerson(person.getKey(), person.getID()) == person;
+    }
+
+    if (inserted && isThere && full.m_current.m_cap * BUCKETSIZE == slots && full.m_old.m_slots == nullptr
+    && (int)full.m_current.m_stash.size() <= STASHSIZE && cuckooValid(full, false)) {
+        cout << "CUCKOO HIGH LOAD PASSED" << endl;
+    } else {
+        cout << "CUCKOO HIGH LOAD FAILED" << endl;
+    }
+
+    // a null combiner hashes key and ID with combineHash, like the default
+    CuckooCache keyOnly(MINPRIME, hashCode, nullptr);
+    bool combined = keyOnly.m_combine == combineHash;
+    for (int id = MINID; id < MINID + 100; id++) {
+        combined = combined && keyOnly.insert(Person("hot", id));
+    }
+    for (int id = MINID; id < MINID + 100; id++) {
+        combined = combined && keyOnly.getPerson("hot", id) == Person("hot", id);
+    }
+
+    if (combined && cuckooValid(keyOnly, false) && cuckooValid(keyOnly, true)) {
+        cout << "CUCKOO NULL COMBINE PASSED" << endl;
+    } else {
+        cout << "CUCKOO NULL COMBINE FAILED" << endl;
+    }
+}
+
+// checks that every entry of the current or old table of a CuckooCache is stored in one of the two buckets of its hash
+// (or in the stash), with the fingerprint of its hash, and that the number of entries matches the size
+bool Tester::cuckooValid(const CuckooCache& cache, bool old) {
+    const CuckooCache::Table& table = old ? cache.m_old : cache.m_current;
+    if (table.m_slots == nullptr) {
+        return true;
+    }
+    int count = 0;
+    for (int i = 0; i < table.m_cap * BUCKETSIZE; i++) {
+        if (table.m_tags[i] != 0) {
+            count++;
+            unsigned int hash = table.m_hashes[i];
+            int bucket = hash & (table.m_cap - 1);
+            int offset = ((hash * 0x5bd1e995u) >> 16) & (table.m_cap - 1);
+            int other = bucket ^ (offset != 0 ? offset : 1);
+            if (hash != cache.hashOf(table.m_slots[i].getKey(), table.m_slots[i].getID())
+            || (i / BUCKETSIZE != bucket && i / BUCKETSIZE != other)) {
+                return false;
+            }
+        }
+    }
+    for (unsigned int i = 0; i < table.m_stash.size(); i++) {
+        if (table.m_stash[i].m_hash != cache.hashOf(table.m_stash[i].m_person.getKey(), table.m_stash[i].m_person.getID())) {
+            return false;
+        }
+    }
+    return count + (int)table.m_stash.size() == table.m_size;
+}
+
+// tests composite hashing, people that share a key are spread over the table instead of sharing one home slot
+void Tester::compositeHash() {
+    // 8 keys with 1000 IDs each, inserted into a key only cache and a composite cache
+    bool isThere = true;
+    bool error = true;
+    vector<Person> dataList;
+    Cache keyOnly(MINPRIME, hashCode);
+    Cache composite(MINPRIME, hashCode, PRIME, combineHash);
+    for (int i = 0; i < 8000; i++) {
+        Person dataObj = Person(searchStr[i % (MAXSEARCH+1)], MINID + i / (MAXSEARCH+1));
+        dataList.push_back(dataObj);
+        keyOnly.insert(dataObj);
+        composite.insert(dataObj);
+    }
+    for (unsigned int i = 0; i < dataList.size(); i++) {
+        isThere = isThere && composite.getPerson(dataList[i].getKey(), dataList[i].getID()) == dataList[i];
+        isThere = isThere && keyOnly.getPerson(dataList[i].getKey(), dataList[i].getID()) == dataList[i];
+    }
+    error = error && !composite.insert(dataList.back()) && composite.getPerson(searchStr[0], MAXID) == EMPTY;
+
+    // counts the distinct home slots of the live entries of both caches
+    int homes[2] = {0, 0};
+    const Cache* caches[2] = {&keyOnly, &composite};
+    for (int c = 0; c < 2; c++) {
+        vector<bool> used(caches[c]->m_currentCap, false);
+        for (int i = 0; i < caches[c]->m_currentCap; i++) {
+            if (caches[c]->m_currentCtrl[i] >= 0) {
+                int home = caches[c]->m_currentHashes[i] % caches[c]->m_currentCap;
+                homes[c] += !used[home];
+                used[home] = true;
+            }
+        }
+    }
+
+    if (isThere && error && homes[0] <= MAXSEARCH+1 && homes[1] > 1000) {
+        cout << "COMPOSITE HASH PASSED" << endl;
+    } else {
+        cout << "COMPOSITE HASH FAILED" << endl;
+    }
+
+    // a custom combiner is used for the stored hashes, removal works and key only hashing stays the default
+    Cache custom(MINPRIME, hashCode, PRIME, addID);
+    RobinHoodCache robinHood(MINPRIME, hashCode, combineHash);
+    bool combined = true;
+    for (int i = 0; i < 50; i++) {
+        custom.insert(dataList[i]);
+        robinHood.insert(dataList[i]);
+    }
+    for (int i = 0; i < custom.m_currentCap; i++) {
+        if (custom.m_currentCtrl[i] >= 0) {
+            const Person& person = custom.m_currentTable[i];
+            combined = combined && custom.m_currentHashes[i] == hashCode(person.getKey()) + person.getID();
+        }
+    }
+    bool removed = custom.remove(dataList[0]) && custom.getPerson(dataList[0].getKey(), dataList[0].getID()) == EMPTY;
+    removed = removed && robinHood.remove(dataList[0]) && robinHood.getPerson(dataList[1].getKey(), dataList[1].getID()) == dataList[1];
+
+    if (combined && removed && keyOnly.m_hasher.m_combine == nullptr && custom.m_hasher.m_combine == addID) {
+        cout << "COMPOSITE HASH COMBINER PASSED" << endl;
+    } else {
+        cout << "COMPOSITE HASH COMBINER FAILED" << endl;
+    }
+}
+
+// tests find, which returns a pointer into the table, and the insert(Person&&) and emplace overloads
+void Tester::findAndMove() {
+    // inserts with all three insert functions until the cache is in the middle of a rehash
+    bool inserted = true;
+    vector<Person> dataList;
+    string longKey(40, 'k');
+    Cache cache(MINPRIME, hashCode);
+    for (int i = 0; i < 400 && (i < 100 || cache.m_oldTable == nullptr); i++) {
+        Person dataObj = Person(longKey + searchStr[i % (MAXSEARCH+1)], MINID + i);
+        dataList.push_back(dataObj);
+        if (i % 3 == 0) {
+            inserted = inserted && cache.insert(dataObj);
+        } else if (i % 3 == 1) {
+            inserted = inserted && cache.insert(Person(dataObj));
+        } else {
+            inserted = inserted && cache.emplace(dataObj.getKey(), dataObj.getID());
+        }
+    }
+    // duplicates are rejected by every overload
+    inserted = inserted && !cache.insert(Person(dataList[0])) && !cache.emplace(dataList[1].getKey(), dataList[1].getID());
+
+    // find returns a pointer to the person stored in either table, and nullptr for a miss
+    bool found = cache.m_oldTable != nullptr;
+    for (unsigned int i = 0; i < dataList.size(); i++) {
+        const Person* person = cache.find(dataList[i].getKey(), dataList[i].getID());
+        found = found && person != nullptr && *person == dataList[i];
+        bool inCurrent = person >= cache.m_currentTable && person < cache.m_currentTable + cache.m_currentCap;
+        bool inOld = person >= cache.m_oldTable && person < cache.m_oldTable + cache.m_oldCap;
+        found = found && (inCurrent || inOld);
+    }
+    found = found && cache.find(longKey, MINID) == nullptr && cache.find(dataList[0].getKey(), MAXID) == nullptr;
+    found = found && cache.remove(dataList[0]) && cache.find(dataList[0].getKey(), dataList[0].getID()) == nullptr;
+
+    if (inserted && found && cache.getPerson(dataList[1].getKey(), dataList[1].getID()) == dataList[1]) {
+        cout << "FIND AND MOVE PASSED" << endl;
+    } else {
+        cout << "FIND AND MOVE FAILED" << endl;
+    }
+}
+
+// tests BasicCache with Word records and a hash functor, including rehashing and removal
+void Tester::basicCache() {
+    // inserts 2000 different words, every 10th word is inserted with emplace
+    bool inserted = true;
+    bool reHash = false;
+    WordCache cache(MINPRIME);
+    for (int i = 0; i < 2000; i++) {
+        string text = searchStr[i % (MAXSEARCH+1)] + to_string(i);
+        if (i % 10 == 0) {
+            inserted = inserted && cache.emplace(Word{text, i});
+        } else {
+            inserted = inserted && cache.insert(Word{text, i});
+        }
+        reHash = reHash || cache.m_oldTable != nullptr;
+    }
+    // duplicates are not inserted, insertOrGet returns the stored word
+    inserted = inserted && !cache.insert(Word{searchStr[0] + "0", 5});
+    pair<Word, bool> result = cache.insertOrGet(Word{searchStr[1] + "1", 5});
+    inserted = inserted && !result.second && result.first.m_count == 1;
+
+    bool found = true;
+    for (int i = 0; i < 2000; i++) {
+        const Word* word = cache.find(searchStr[i % (MAXSEARCH+1)] + to_string(i));
+        found = found && word != nullptr && word->m_count == i;
+    }
+    found = found && cache.find("scheme") == nullptr;
+
+    if (inserted && found && reHash && cache.m_hasher(searchStr[0]) == hashCode(searchStr[0])) {
+        cout << "BASIC CACHE INSERT PASSED" << endl;
+    } else {
+        cout << "BASIC CACHE INSERT FAILED" << endl;
+    }
+
+    // removes every other word
+    bool removed = true;
+    for (int i = 0; i < 2000; i += 2) {
+        removed = removed && cache.remove(searchStr[i % (MAXSEARCH+1)] + to_string(i));
+    }
+    removed = removed && !cache.remove(searchStr[0] + "0");
+    for (int i = 0; i < 2000; i++) {
+        const Word* word = cache.find(searchStr[i % (MAXSEARCH+1)] + to_string(i));
+        removed = removed && (i % 2 == 0 ? word == nullptr : word != nullptr && word->m_count == i);
+    }
+
+    if (removed) {
+        cout << "BASIC CACHE REMOVE PASSED" << endl;
+    } else {
+        cout << "BASIC CACHE REMOVE FAILED" << endl;
+    }
+}
+
+// tests the built-in hash functions: wyhash against its published test vectors, avalanche (flipping any input bit
+// flips every output bit with probability 1/2) and the distribution of hashes over the buckets of a table
+void Tester::hashers() {
+    // test vectors of wyhash final version 4, the seed of the i-th string is i
+    const string vectors[7] = {"", "a", "abc", "message digest", "abcdefghijklmnopqrstuvwxyz",
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789",
+        "12345678901234567890123456789012345678901234567890123456789012345678901234567890"};
+    const unsigned long long expected[7] = {0x0409638ee2bde459ULL, 0xa8412d091b5fe0a9ULL, 0x32dd92e4b2915153ULL,
+        0x8619124089a3a16bULL, 0x7a43afb61d7f5f40ULL, 0xff42329b90e50d58ULL, 0xc39cab13b115aad3ULL};
+    bool correct = true;
+    for (int i = 0; i < 7; i++) {
+        correct = correct && wyhash(vectors[i], i) == expected[i];
+    }
+    if (correct) {
+        cout << "WYHASH VECTORS PASSED" << endl;
+    } else {
+        cout << "WYHASH VECTORS FAILED" << endl;
+    }
+
+    // avalanche, for keys of every read path of wyhash. counts how often each output bit flips when one input bit is
+    // flipped, over all input bits of random keys (at least 100 keys and 10000 flips), and checks that every count is
+    // close to half
+    mt19937 generator(10);
+    const int lengths[6] = {3, 8, 16, 40, 100, 200};
+    bool avalanche = true;
+    for (int l = 0; l < 6; l++) {
+        int flips[64] = {0};
+        int samples = 0;
+        for (int k = 0; k < 100 || samples < 10000; k++) {
+            string key(lengths[l], ' ');
+            for (int i = 0; i < lengths[l]; i++) {
+                key[i] = (char)generator();
+            }
+            unsigned long long hash = wyhash(key);
+            for (int bit = 0; bit < lengths[l] * 8; bit++) {
+                key[bit / 8] ^= (char)(1 << (bit % 8));
+                unsigned long long difference = hash ^ wyhash(key);
+                key[bit / 8] ^= (char)(1 << (bit % 8));
+                for (int out = 0; out < 64; out++) {
+                    flips[out] += (difference >> out) & 1;
+                }
+                samples++;
+            }
+        }
+        for (int out = 0; out < 64; out++) {
+            double probability = double(flips[out]) / samples;
+            avalanche = avalanche && probability > 0.45 && probability < 0.55;
+        }
+    }
+    if (avalanche) {
+        cout << "HASH AVALANCHE PASSED" << endl;
+    } else {
+        cout << "HASH AVALANCHE FAILED" << endl;
+    }
+
+    // distribution over the buckets of a prime and a power of two table, for short keys and for 40 byte keys. the
+    // chi-square statistic divided by its expected value (buckets - 1) is about 1 for a uniform hash
+    bool uniform = true;
+    const string prefixes[2] = {"key", string(40, 'k')};
+    for (int p = 0; p < 2; p++) {
+        uniform = uniform && chiSquare(wyHash, prefixes[p], 1009, false) < 1.15;
+        uniform = uniform && chiSquare(wyHash, prefixes[p], 1024, true) < 1.15;
+        uniform = uniform && chiSquare(fnv1aHash, prefixes[p], 1009, false) < 1.15;
+    }
+    // a Cache works with the built-in hash functions like with any other hash_fn
+    Cache cache(MINPRIME, wyHash);
+    Cache composite(MINPRIME, fnv1aHash, POWEROFTWO, combineHash);
+    bool isThere = true;
+    for (int i = 0; i < 2000; i++) {
+        Person person(string(100, 'k') + to_string(i), MINID + i % 10);
+        isThere = isThere && cache.insert(person) && composite.insert(person);
+    }
+    for (int i = 0; i < 2000; i++) {
+        string key = string(100, 'k') + to_string(i);
+        isThere = isThere && cache.find(key, MINID + i % 10) != nullptr && composite.find(key, MINID + i % 10) != nullptr;
+    }
+    if (uniform && isThere) {
+        cout << "HASH DISTRIBUTION PASSED" << endl;
+    } else {
+        cout << "HASH DISTRIBUTION FAILED" << endl;
+    }
+}
+
+// hashes 100000 keys (prefix followed by a number) into the given number of buckets, with hash % buckets or with the
+// low bits of the hash if mask is true, and returns the chi-square statistic divided by buckets - 1
+double Tester::chiSquare(hash_fn hash, const string& prefix, int buckets, bool mask) {
+    const int keys = 100000;
+    vector<int> counts(buckets, 0);
+    for (int i = 0; i < keys; i++) {
+        unsigned int h = hash(prefix + to_string(i));
+        counts[mask ? h & (buckets - 1) : h % buckets]++;
+    }
+    double expected = double(keys) / buckets;
+    double chi = 0;
+    for (int i = 0; i < buckets; i++) {
+        chi += (counts[i] - expected) * (counts[i] - expected) / expected;
+    }
+    return chi / (buckets - 1);
+}
+
+// tests that a cache with a probe limit picks a new seed when keys collide in its slots, and that people are still
+// found while the table with the old seed is drained
+void Tester::reseed() {
+    // 40 keys with different hashes that all start probing at slot 0 of the first table (hash % 101 == 0)
+    vector<Person> dataList;
+    for (int i = 0; dataList.size() < 40; i++) {
+        string key = "flood" + to_string(i);
+        if (hashCode(key) % 101 == 0) {
+            dataList.push_back(Person(key, MINID + i % 1000));
+        }
+    }
+
+    // without a probe limit the keys stay in one long probe sequence
+    Cache plain(MINPRIME, hashCode);
+    Cache limited(MINPRIME, hashCode);
+    limited.setProbeLimit(8);
+    bool isThere = true;
+    bool duringRehash = false;
+    for (unsigned int i = 0; i < dataList.size(); i++) {
+        plain.insert(dataList[i]);
+        limited.insert(dataList[i]);
+        // every person inserted so far is found, also while the old table still uses the old seed
+        if (limited.m_oldTable != nullptr && limited.m_oldSeed != limited.m_currentSeed) {
+            duringRehash = true;
+        }
+        for (unsigned int j = 0; j <= i; j++) {
+            isThere = isThere && limited.find(dataList[j].getKey(), dataList[j].getID()) != nullptr;
+        }
+    }
+    for (int i = 0; i < 20; i++) {
+        isThere = isThere && limited.remove(dataList[i]);
+        isThere = isThere && limited.getPerson(dataList[i].getKey(), dataList[i].getID()) == EMPTY;
+    }
+    for (unsigned int i = 20; i < dataList.size(); i++) {
+        isThere = isThere && limited.getPerson(dataList[i].getKey(), dataList[i].getID()) == dataList[i];
+    }
+
+    // the stored hashes of the reseeded table are the seeded hashes
+    bool seeded = limited.m_currentSeed != 0;
+    for (int i = 0; i < limited.m_currentCap; i++) {
+        if (limited.m_currentCtrl[i] >= 0) {
+            unsigned int hash = mixSeed(hashCode(limited.m_currentTable[i].getKey()), limited.m_currentSeed);
+            seeded = seeded && limited.m_currentHashes[i] == hash;
+        }
+    }
+
+    if (isThere && seeded && duringRehash && limited.m_reseeds >= 1 && plain.m_reseeds == 0 && plain.m_currentSeed == 0) {
+        cout << "RESEED PASSED" << endl;
+    } else {
+        cout << "RESEED FAILED" << endl;
+    }
+
+    // a hasher that takes a seed gets it directly
+    BasicCache<PersonKey, Person, WyPersonHash> wy(MINPRIME);
+    wy.setProbeLimit(1);
+    bool inserted = true;
+    for (int i = 0; i < 40; i++) {
+        inserted = inserted && wy.insert(Person("key" + to_string(i), MINID));
+    }
+    bool direct = wy.m_reseeds >= 1;
+    for (int i = 0; i < wy.m_currentCap; i++) {
+        if (wy.m_currentCtrl[i] >= 0) {
+            PersonKey key = keyOf(wy.m_currentTable[i]);
+            direct = direct && wy.m_currentHashes[i] == foldHash(WyPersonHash()(key, wy.m_currentSeed));
+        }
+    }
+    for (int i = 0; i < 40; i++) {
+        inserted = inserted && wy.find(PersonKey{"key" + to_string(i), MINID}) != nullptr;
+    }
+
+    if (inserted && direct) {
+        cout << "RESEED SEEDED HASHER PASSED" << endl;
+    } else {
+        cout << "RESEED SEEDED HASHER FAILED" << endl;
+    }
+
+    // one hot key with 3000 IDs hashed by key only, and 64 keys whose hashCode hashes are all equal ("Ab" and "BA"
+    // hash alike, so do all 6 block strings of them): every long probe sequence holds one hash, no seed can shorten
+    // it, so neither cache reseeds
+    Cache hot(MINPRIME, hashCode);
+    Cache equal(MINPRIME, hashCode);
+    hot.setProbeLimit(16);
+    equal.setProbeLimit(16);
+    bool stays = true;
+    for (int id = MINID; id < MINID + 3000; id++) {
+        stays = hot.insert(Person("hot", id)) && stays;
+    }
+    vector<string> equalKeys;
+    for (int bits = 0; bits < 64; bits++) {
+        string key;
+        for (int block = 0; block < 6; block++) {
+            key += (bits >> block) & 1 ? "BA" : "Ab";
+        }
+        equalKeys.push_back(key);
+        stays = equal.insert(Person(key, MINID)) && hashCode(key) == hashCode(equalKeys[0]) && stays;
+    }
+    for (int id = MINID; id < MINID + 3000; id++) {
+        stays = stays && hot.find("hot", id) != nullptr;
+    }
+    for (const string& key : equalKeys) {
+        stays = stays && equal.find(key, MINID) != nullptr;
+    }
+    stays = stays && hot.m_reseeds == 0 && equal.m_reseeds == 0;
+
+    // a Cache with a seeded hash function gets the seed itself, the equal keys of hashCode have different hashes
+    // and a reseeded table stores the hashes of the new seed
+    Cache seededCache(MINPRIME, wySeededHash);
+    seededCache.setProbeLimit(1);
+    set<unsigned int> hashes;
+    for (const string& key : equalKeys) {
+        stays = seededCache.insert(Person(key, MINID)) && stays;
+        hashes.insert(foldHash(wySeededHash(key, 0)));
+    }
+    stays = stays && hashes.size() == equalKeys.size() && seededCache.m_reseeds >= 1;
+    for (int i = 0; i < seededCache.m_currentCap; i++) {
+        if (seededCache.m_currentCtrl[i] >= 0) {
+            string_view key = seededCache.m_currentTable[i].m_key;
+            stays = stays && seededCache.m_currentHashes[i] == foldHash(wySeededHash(key, seededCache.m_currentSeed));
+        }
+    }
+    for (const string& key : equalKeys) {
+        stays = stays && seededCache.find(key, MINID) != nullptr;
+    }
+
+    // keys that keep running into long probe sequences reseed with backoff, not on every long insert
+    BasicCache<PersonKey, Person, WyPersonHash> backoff(MINPRIME);
+    backoff.setProbeLimit(1);
+    for (int i = 0; i < 20000; i++) {
+        stays = backoff.insert(Person("backoff" + to_string(i), MINID)) && stays;
+    }
+    stays = stays && backoff.m_reseeds >= 1 && backoff.m_reseeds <= 8;
+
+    if (stays) {
+        cout << "RESEED HOT KEY PASSED" << endl;
+    } else {
+        cout << "RESEED HOT KEY FAILED" << endl;
+    }
+}
+
+void Tester::migrationBudget() {
+    const int NUM = 20000;
+    POLICY policies[] = {PRIME, POWEROFTWO};
+    for (POLICY policy : policies) {
+        string name = policy == PRIME ? "PRIME" : "POWEROFTWO";
+        // the cursor only moves forward while an old table exists, and every slot before it has been transferred
+        Cache plain(MINPRIME, hashCode, policy);
+        // each operation scans 8 slots, more only when the old table would not be finished in time
+        Cache budget(MINPRIME, hashCode, policy);
+        budget.setMigrationBudget(8);
+        // a time limit only
+        Cache timed(MINPRIME, hashCode, policy);
+        timed.setMigrationBudget(0, 1);
+        bool cursor = true;
+        bool bounded = true;
+        bool inserted = true;
+        int maxScan = 0;
+        for (int i = 0; i < NUM; i++) {
+            Person person("key" + to_string(i), MINID + i % 1000);
+            const Person* oldPlain = plain.m_oldTable;
+            int before = plain.m_cursor;
+            inserted = inserted && plain.insert(person) && timed.insert(person);
+            if (oldPlain != nullptr && plain.m_oldTable == oldPlain) {
+                cursor = cursor && plain.m_cursor >= before;
+                for (int j = 0; j < plain.m_cursor && j < plain.m_oldCap; j++) {
+                    cursor = cursor && plain.m_oldCtrl[j] < 0;
+                }
+            }
+
+            const Person* oldBudget = budget.m_oldTable;
+            int minimum = oldBudget != nullptr ? budget.minimumScan() : 0;
+            before = budget.m_cursor;
+            inserted = inserted && budget.insert(person);
+            if (oldBudget != nullptr && budget.m_oldTable == oldBudget) {
+                int scanned = budget.m_cursor - before;
+                bounded = bounded && scanned <= (minimum > 8 ? minimum : 8);
+                maxScan = scanned > maxScan ? scanned : maxScan;
+            }
+            // the old table is always gone before the current table grows past a load factor of 0.5
+            bounded = bounded && (budget.m_oldTable == nullptr || budget.lambda() <= 0.5);
+        }
+        for (int i = 0; i < NUM; i += 7) {
+            plain.remove(Person("key" + to_string(i), MINID + i % 1000));
+            budget.remove(Person("key" + to_string(i), MINID + i % 1000));
+            timed.remove(Person("key" + to_string(i), MINID + i % 1000));
+        }
+
+        // every person that was not removed is still found, and no one is lost in the transfer
+        bool isThere = true;
+        int live = 0;
+        for (int i = 0; i < NUM; i++) {
+            bool removed = i % 7 == 0;
+            Person person("key" + to_string(i), MINID + i % 1000);
+            isThere = isThere && (plain.getPerson(person.getKey(), person.getID()) == person) != removed;
+            isThere = isThere && (budget.getPerson(person.getKey(), person.getID()) == person) != removed;
+            isThere = isThere && (timed.getPerson(person.getKey(), person.getID()) == person) != removed;
+            live += !removed;
+        }
+        int stored = budget.m_currentSize - budget.m_currNumDeleted;
+        if (budget.m_oldTable != nullptr) {
+            stored += budget.m_oldSize - budget.m_oldNumDeleted;
+        }
+
+        if (cursor && bounded && inserted && isThere && stored == live && maxScan <= 64) {
+            cout << "MIGRATION BUDGET " << name << " PASSED" << endl;
+        } else {
+            cout << "MIGRATION BUDGET " << name << " FAILED" << endl;
+        }
+    }
+}
+
+void Tester::backgroundMigration() {
+    const int NUM = 20000;
+    Cache cache(MINPRIME, hashCode);
+    cache.setBackgroundMigration(true);
+    bool inserted = true;
+    bool isThere = true;
+    for (int i = 0; i < NUM; i++) {
+        Person person("key" + to_string(i), MINID + i % 1000);
+        inserted = inserted && cache.insert(person);
+        // the old table is always gone before the current table grows past a load factor of 0.5
+        inserted = inserted && cache.lambda() <= 0.5;
+        isThere = isThere && cache.getPerson(person.getKey(), person.getID()) == person;
+    }
+
+    // after a rehash readers look every person up while the migrator thread drains the old table
+    // the lock keeps the migrator thread away until the next rehash has happened
+    cache.m_lock.lock();
+    for (int i = 0; cache.m_oldTable == nullptr || cache.m_cursor >= cache.m_oldCap; i++) {
+        cache.insert(Person("grow" + to_string(i), MINID));
+    }
+    int chunks = cache.m_migratorChunks;
+    cache.m_lock.unlock();
+    vector<thread> readers;
+    vector<int> hits(4, 0);
+    for (int r = 0; r < 4; r++) {
+        readers.push_back(thread([&cache, &hits, r]() {
+            for (int i = r; i < NUM; i += 4) {
+                hits[r] += cache.getPerson("key" + to_string(i), MINID + i % 1000) == Person("key" + to_string(i), MINID + i % 1000);
+            }
+        }));
+    }
+    for (thread& reader : readers) {
+        reader.join();
+    }
+    int found = 0;
+    for (int hit : hits) {
+        found += hit;
+    }
+
+    // waits for the migrator thread to scan the whole old table
+    bool drained = false;
+    for (int i = 0; i < 1000 && !drained; i++) {
+        cache.m_lock.lock();
+        drained = cache.m_oldTable == nullptr || cache.m_cursor >= cache.m_oldCap;
+        cache.m_lock.unlock();
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+    cache.setBackgroundMigration(false);
+    bool worked = cache.m_migratorChunks > chunks;
+
+    // removes and lookups still work after the thread is stopped
+    for (int i = 0; i < NUM; i += 2) {
+        isThere = isThere && cache.remove(Person("key" + to_string(i), MINID + i % 1000));
+    }
+    for (int i = 0; i < NUM; i++) {
+        Person person("key" + to_string(i), MINID + i % 1000);
+        isThere = isThere && (cache.getPerson(person.getKey(), person.getID()) == person) == (i % 2 == 1);
+    }
+
+    if (inserted && isThere && found == NUM && drained && worked) {
+        cout << "BACKGROUND MIGRATION PASSED" << endl;
+    } else {
+        cout << "BACKGROUND MIGRATION FAILED" << endl;
+    }
+}
+
+void Tester::sharded() {
+    const int THREADS = 8;
+    const int NUM = 1000; // people per thread, all of them with different IDs
+    // 64 hot keys shared by all IDs, the people of one key end up in every shard
+    ShardedCache cache(MINPRIME, hashCode, 10);
+    bool rounded = cache.m_shards.size() == 16;
+
+    // every thread inserts its own people, removes every other one and looks all of them up, while the other threads
+    // do the same in the same shards
+    vector<thread> threads;
+    vector<int> errors(THREADS, 0);
+    for (int t = 0; t < THREADS; t++) {
+        threads.push_back(thread([&cache, &errors, t, NUM]() {
+            for (int i = 0; i < NUM; i++) {
+                errors[t] += !cache.insert(Person("key" + to_string(i % 64), MINID + t * NUM + i));
+            }
+            for (int i = 0; i < NUM; i += 2) {
+                errors[t] += !cache.remove(Person("key" + to_string(i % 64), MINID + t * NUM + i));
+            }
+            for (int i = 0; i < NUM; i++) {
+                Person person("key" + to_string(i % 64), MINID + t * NUM + i);
+                errors[t] += (cache.getPerson(person.getKey(), person.getID()) == person) != (i % 2 == 1);
+            }
+        }));
+    }
+    for (thread& t : threads) {
+        t.join();
+    }
+    int total = 0;
+    for (int error : errors) {
+        total += error;
+    }
+
+    // every person is in the shard shardOf picks, and each shard holds some of them
+    bool placed = true;
+    int live = 0;
+    for (unsigned int s = 0; s < cache.m_shards.size(); s++) {
+        Cache& shard = cache.m_shards[s]->m_cache;
+        int count = 0;
+        for (int i = 0; i < shard.m_currentCap; i++) {
+            if (shard.m_currentCtrl[i] >= 0) {
+                const Person& person = slotAt(shard, i);
+                placed = placed && &cache.shardOf(person.getKey(), person.getID()) == cache.m_shards[s].get();
+                count++;
+            }
+        }
+        if (shard.m_oldTable != nullptr) {
+            count += shard.m_oldSize - shard.m_oldNumDeleted;
+        }
+        placed = placed && count > 0;
+        live += count;
+    }
+
+    // duplicates and IDs out of range are rejected like in Cache
+    bool errorCase = !cache.insert(Person("key1", MINID + 1)) && !cache.insert(Person("key1", MAXID + 1))
+        && !cache.remove(Person("key0", MINID)) && cache.getPerson("key0", MINID) == EMPTY;
+
+    if (rounded && total == 0 && placed && live == THREADS * NUM / 2 && errorCase) {
+        cout << "SHARDED PASSED" << endl;
+    } else {
+        cout << "SHARDED FAILED" << endl;
+    }
+}
+
+void Tester::concurrentReads() {
+    const int STABLE = 500;     // people that are never removed
+    const int ROUNDS = 6;       // rounds of growing the table with other people and removing them again
+    const int GROWTH = 6000;    // people inserted and removed in each round
+    ConcurrentCache cache(MINPRIME, hashCode, combineHash);
+    bool inserted = true;
+    for (int i = 0; i < STABLE; i++) {
+        inserted = inserted && cache.insert(Person("stable" + to_string(i), MINID + i));
+    }
+
+    // readers look the stable people up without a lock while the writer grows, rehashes and empties the table
+    atomic<bool> done(false);
+    vector<int> misses(4, 0);
+    vector<int> reads(4, 0);
+    vector<thread> readers;
+    for (int r = 0; r < 4; r++) {
+        readers.push_back(thread([&cache, &done, &misses, &reads, r]() {
+            for (int i = r; !done.load() || reads[r] < STABLE; i = (i + 7) % STABLE) {
+                Person person("stable" + to_string(i), MINID + i);
+                misses[r] += !(cache.getPerson(person.getKey(), person.getID()) == person);
+                reads[r]++;
+            }
+        }));
+    }
+    int rehashes = 0;
+    for (int round = 0; round < ROUNDS; round++) {
+        for (int i = 0; i < GROWTH; i++) {
+            const ConcurrentCache::Table* current = cache.m_current.load();
+            inserted = inserted && cache.insert(Person("grow" + to_string(i), MINID + i));
+            rehashes += cache.m_current.load() != current;
+        }
+        for (int i = 0; i < GROWTH; i++) {
+            inserted = inserted && cache.remove(Person("grow" + to_string(i), MINID + i));
+        }
+    }
+    done.store(true);
+    for (thread& reader : readers) {
+        reader.join();
+    }
+    int missed = 0;
+    for (int miss : misses) {
+        missed += miss;
+    }
+
+    // removed people are gone, and duplicates and IDs out of range are rejected
+    bool isThere = cache.getPerson("grow1", MINID + 1) == EMPTY && !cache.insert(Person("stable1", MINID + 1))
+        && !cache.insert(Person("new", MAXID + 1)) && !cache.remove(Person("grow1", MINID + 1));
+    // without readers the next writes free every retired entry and table
+    for (int i = 0; i < RETIREBATCH; i++) {
+        cache.insert(Person("last" + to_string(i), MINID + i));
+        cache.remove(Person("last" + to_string(i), MINID + i));
+    }
+    bool reclaimed = cache.m_retired.size() < (size_t)RETIREBATCH;
+
+    if (inserted && missed == 0 && rehashes >= ROUNDS && isThere && reclaimed) {
+        cout << "CONCURRENT READS PASSED" << endl;
+    } else {
+        cout << "CONCURRENT READS FAILED" << endl;
+    }
+}
+
+void Tester::lockFree() {
+    const int THREADS = 4;
+    const int NUM = 1000;       // people of each thread, enough to resize the table several times
+    const int OPS = 20000;      // random operations of each thread
+    const int SHARED = 300;     // people every thread tries to insert and remove at the same time
+    LockFreeCache cache(MINPRIME, hashCode);
+    int firstCap = cache.m_top.load()->m_cap;
+
+    // every thread runs random operations on its own people and checks each result against a set of the IDs it
+    // inserted, the same key with different IDs makes the threads probe through each other's people
+    vector<set<int>> models(THREADS);
+    vector<int> wrong(THREADS, 0);
+    vector<thread> threads;
+    for (int t = 0; t < THREADS; t++) {
+        threads.push_back(thread([&cache, &models, &wrong, t]() {
+            mt19937 random(t + 1);
+            set<int>& model = models[t];
+            for (int i = 0; i < OPS; i++) {
+                int id = MINID + t * NUM + int(random() % NUM);
+                Person person("own" + to_string(id % 100), id);
+                unsigned int kind = random() % 4;
+                if (kind < 2) {
+                    wrong[t] += cache.insert(person) != model.insert(id).second;
+                } else if (kind == 2) {
+                    wrong[t] += cache.remove(person) != (model.erase(id) == 1);
+                } else {
+                    bool found = cache.getPerson(person.getKey(), id) == person;
+                    wrong[t] += found != (model.count(id) == 1);
+                }
+            }
+        }));
+    }
+    for (thread& t : threads) {
+        t.join();
+    }
+    int mistakes = 0;
+    for (int count : wrong) {
+        mistakes += count;
+    }
+
+    // contended people: exactly one insert and one remove of each succeeds, however many threads try
+    vector<int> inserts(THREADS, 0);
+    vector<int> removes(THREADS, 0);
+    for (int round = 0; round < 2; round++) {
+        threads.clear();
+        for (int t = 0; t < THREADS; t++) {
+            threads.push_back(thread([&cache, &inserts, &removes, round, t]() {
+                for (int i = 0; i < SHARED; i++) {
+                    Person person("shared", MINID + (i + t * 7) % SHARED);
+                    if (round == 0) {
+                        inserts[t] += cache.insert(person);
+                    } else {
+                        removes[t] += cache.remove(person);
+                    }
+                }
+            }));
+        }
+        for (thread& t : threads) {
+            t.join();
+        }
+    }
+    int inserted = 0, removed = 0;
+    for (int t = 0; t < THREADS; t++) {
+        inserted += inserts[t];
+        removed += removes[t];
+    }
+
+    // the cache holds exactly the union of the models
+    int expected = 0;
+    bool contents = true;
+    for (int t = 0; t < THREADS; t++) {
+        expected += models[t].size();
+        for (int i = 0; i < NUM; i++) {
+            int id = MINID + t * NUM + i;
+            Person person("own" + to_string(id % 100), id);
+            contents = contents && (cache.getPerson(person.getKey(), id) == person) == (models[t].count(id) == 1);
+        }
+    }
+    contents = contents && cache.m_count.load() == expected && cache.getPerson("shared", MINID) == EMPTY;
+    bool grew = cache.m_top.load()->m_cap > firstCap && cache.m_top.load()->m_next.load() == nullptr;
+    bool rejected = !cache.insert(Person("new", MAXID + 1)) && !cache.insert(Person("new", MINID - 1));
+
+    if (mistakes == 0 && inserted == SHARED && removed == SHARED && contents && grew && rejected) {
+        cout << "LOCK FREE PASSED" << endl;
+    } else {
+        cout << "LOCK FREE FAILED" << endl;
+    }
+}
+
+void Tester::lockFreeCopy() {
+    const int THREADS = 3;
+    const int NUM = 200;        // people of each thread
+    const int OPS = 20000;      // random operations of each thread
+    // a copier stalls on a frozen slot while another copier finishes it, the person is removed from the next table
+    // and that one is copied into a third table. the stalled copier then goes on and must not bring the person back
+    LockFreeCache cache(MINPRIME, hashCode);
+    Person person("stalled", MINID);
+    cache.insert(person);
+    bool stays = true;
+    {
+        EpochGuard guard;
+        LockFreeCache::Table* first = cache.m_top.load();
+        int h = 0;
+        while (first->m_keys[h].load() == nullptr || !(first->m_keys[h].load()->m_person == person)) {
+            h++;
+        }
+        LockFreeCache::Entry* stalled = first->m_keys[h].load();
+        cache.resize(first);
+        first->m_states[h].fetch_or(STATEFROZEN);
+        cache.copySlot(first, h);
+        bool removed = cache.remove(person);
+        LockFreeCache::Table* second = first->m_next.load();
+        cache.resize(second);
+        for (int i = 0; i < first->m_cap; i++) {
+            cache.copySlot(first, i);
+        }
+        for (int i = 0; i < second->m_cap; i++) {
+            cache.copySlot(second, i);
+        }
+        cache.copyLive(second, stalled);
+        LockFreeCache::Table* third = second->m_next.load();
+        int live = 0;
+        for (int i = 0; i < third->m_cap; i++) {
+            live += third->m_states[i].load() == STATELIVE;
+        }
+        stays = removed && live == 0 && cache.m_top.load() == third && cache.getPerson("stalled", MINID) == EMPTY
+            && cache.m_count.load() == 0;
+    }
+
+    // stress: the threads insert and remove their own people while another thread resizes the top table again and
+    // again, so copies of every table run into removes and into the copy of the table after it
+    vector<set<int>> models(THREADS);
+    vector<int> wrong(THREADS, 0);
+    atomic<bool> running(true);
+    thread resizer([&cache, &running]() {
+        while (running.load()) {
+            EpochGuard guard;
+            LockFreeCache::Table* top = cache.m_top.load();
+            cache.resize(top);
+            cache.helpCopy(top);
+        }
+    });
+    vector<thread> threads;
+    for (int t = 0; t < THREADS; t++) {
+        threads.push_back(thread([&cache, &models, &wrong, t]() {
+            mt19937 random(t + 1);
+            set<int>& model = models[t];
+            for (int i = 0; i < OPS; i++) {
+                int id = MINID + 1 + t * NUM + int(random() % NUM);
+                Person person("copied" + to_string(id % 10), id);
+                if (random() % 2 == 0) {
+                    wrong[t] += cache.insert(person) != model.insert(id).second;
+                } else {
+                    wrong[t] += cache.remove(person) != (model.erase(id) == 1);
+                }
+            }
+        }));
+    }
+    for (thread& t : threads) {
+        t.join();
+    }
+    running.store(false);
+    resizer.join();
+    int mistakes = 0;
+    int expected = 0;
+    for (int t = 0; t < THREADS; t++) {
+        mistakes += wrong[t];
+        expected += models[t].size();
+        for (int i = 0; i < NUM; i++) {
+            int id = MINID + 1 + t * NUM + i;
+            Person person("copied" + to_string(id % 10), id);
+            mistakes += (cache.getPerson(person.getKey(), id) == person) != (models[t].count(id) == 1);
+        }
+    }
+
+    if (stays && mistakes == 0 && cache.m_count.load() == expected) {
+        cout << "LOCK FREE COPY PASSED" << endl;
+    } else {
+        cout << "LOCK FREE COPY FAILED" << endl;
+    }
+}
+
+void Tester::eviction() {
+    const int LIMIT = 500;
+    const int NUM = 5000;
+    const int HOT = 100;
+    POLICY policies[] = {PRIME, POWEROFTWO};
+    for (POLICY policy : policies) {
+        string name = policy == PRIME ? "PRIME" : "POWEROFTWO";
+        // a full cache evicts on every insert and never holds more than the limit, also while an old table is drained
+        // one slot at a time (values are evicted from it while the current table is empty)
+        Cache plain(MINPRIME, hashCode, policy);
+        plain.setEvictionLimit(LIMIT);
+        Cache slow(MINPRIME, hashCode, policy);
+        slow.setEvictionLimit(LIMIT);
+        slow.setMigrationBudget(1);
+        bool inserted = true;
+        bool bounded = true;
+        for (int i = 0; i < NUM; i++) {
+            Person person("scan" + to_string(i), MINID + i);
+            inserted = inserted && plain.insert(person) && slow.insert(person);
+            bounded = bounded && plain.liveCount() <= LIMIT && slow.liveCount() <= LIMIT;
+        }
+        int found = 0;
+        for (int i = 0; i < NUM; i++) {
+            found += plain.find("scan" + to_string(i), MINID + i) != nullptr;
+            found += slow.find("scan" + to_string(i), MINID + i) != nullptr;
+        }
+        bool counted = found == 2 * LIMIT && plain.stats().m_evictions == NUM - LIMIT
+            && slow.stats().m_evictions == NUM - LIMIT && plain.stats().m_hits == LIMIT
+            && plain.stats().m_misses == NUM - LIMIT;
+        // a duplicate is rejected without evicting anything
+        plain.resetStats();
+        Person last("scan" + to_string(NUM - 1), MINID + NUM - 1);
+        bool duplicate = !plain.insert(last) && plain.stats().m_evictions == 0 && plain.liveCount() == LIMIT;
+
+        // scan resistance: people that are found again survive a scan of people that are inserted only once
+        Cache hot(MINPRIME, hashCode, policy);
+        hot.setEvictionLimit(2 * HOT);
+        for (int i = 0; i < HOT; i++) {
+            hot.insert(Person("hot" + to_string(i), MINID + i));
+            hot.find("hot" + to_string(i), MINID + i);
+        }
+        for (int i = 0; i < NUM; i++) {
+            hot.insert(Person("scan" + to_string(i), MINID + i));
+            if (i % (HOT / 4) == 0) {
+                for (int j = 0; j < HOT; j++) {
+                    hot.find("hot" + to_string(j), MINID + j);
+                }
+            }
+        }
+        int survivors = 0;
+        for (int i = 0; i < HOT; i++) {
+            survivors += hot.find("hot" + to_string(i), MINID + i) != nullptr;
+        }
+
+        // lowering the limit evicts right away, turning it off frees the counters and inserts never evict again
+        plain.setEvictionLimit(LIMIT / 5);
+        bool lowered = plain.liveCount() == LIMIT / 5;
+        plain.setEvictionLimit(0);
+        plain.resetStats();
+        for (int i = 0; i < LIMIT; i++) {
+            inserted = inserted && plain.insert(Person("more" + to_string(i), MINID + i));
+        }
+        bool unbounded = plain.m_currentRefs == nullptr && plain.liveCount() == LIMIT + LIMIT / 5
+            && plain.stats().m_evictions == 0;
+
+        if (inserted && bounded && counted && duplicate && survivors == HOT && lowered && unbounded) {
+            cout << "EVICTION " << name << " PASSED" << endl;
+        } else {
+            cout << "EVICTION " << name << " FAILED" << endl;
+        }
+    }
+}
+
+void Tester::admission() {
+    const int LIMIT = 200;
+    const int HOT = 100;
+    const int NUM = 5000;
+    // the first record only goes into the doorkeeper, the estimate counts it anyway and stops at MAXFREQUENCY + 1
+    FrequencySketch sketch(LIMIT);
+    bool estimates = sketch.frequency(12345) == 0;
+    for (int i = 1; i <= 20; i++) {
+        sketch.record(12345);
+        estimates = estimates && sketch.frequency(12345) == (i < MAXFREQUENCY + 1 ? i : MAXFREQUENCY + 1);
+    }
+    // aging halves the counters and forgets the doorkeeper, a hash recorded once is gone
+    sketch.record(777);
+    sketch.age();
+    bool aged = sketch.frequency(12345) == MAXFREQUENCY / 2 && sketch.frequency(777) == 0;
+    // enough records age the sketch on their own
+    for (int i = 0; i < SAMPLEFACTOR * LIMIT; i++) {
+        sketch.record(i % 1000 + 100000);
+        sketch.record(i % 1000 + 100000);
+    }
+    aged = aged && sketch.frequency(12345) < MAXFREQUENCY / 2;
+
+    POLICY policies[] = {PRIME, POWEROFTWO};
+    for (POLICY policy : policies) {
+        string name = policy == PRIME ? "PRIME" : "POWEROFTWO";
+        // hot people are found over and over, then a scan of people that are inserted once is mostly turned away
+        // instead of evicting them, and the cache keeps them all
+        Cache cache(MINPRIME, hashCode, policy);
+        cache.setEvictionLimit(LIMIT);
+        cache.setAdmission(true);
+        for (int i = 0; i < HOT; i++) {
+            cache.insert(Person("hot" + to_string(i), MINID + i));
+        }
+        for (int round = 0; round < 3; round++) {
+            for (int i = 0; i < HOT; i++) {
+                cache.find("hot" + to_string(i), MINID + i);
+            }
+        }
+        int admitted = 0;
+        for (int i = 0; i < NUM; i++) {
+            admitted += cache.insert(Person("scan" + to_string(i), MINID + i));
+        }
+        int survivors = 0;
+        for (int i = 0; i < HOT; i++) {
+            survivors += cache.find("hot" + to_string(i), MINID + i) != nullptr;
+        }
+        CacheStats stats = cache.stats();
+        bool rejected = stats.m_rejections > (unsigned long long)NUM / 2
+            && stats.m_rejections + stats.m_evictions + LIMIT - HOT == (unsigned long long)NUM
+            && cache.liveCount() == LIMIT;
+
+        // a new person that keeps being looked up gets in after a few tries
+        int tries = 0;
+        while (tries < 20 && cache.find("late", MINID) == nullptr) {
+            cache.insert(Person("late", MINID));
+            tries++;
+        }
+        bool late = cache.find("late", MINID) != nullptr && tries > 1;
+
+        // without an eviction limit the admission policy does nothing
+        Cache unbounded(MINPRIME, hashCode, policy);
+        unbounded.setAdmission(true);
+        bool inactive = unbounded.m_sketch == nullptr && unbounded.insert(Person("once", MINID));
+        unbounded.setEvictionLimit(LIMIT);
+        inactive = inactive && unbounded.m_sketch != nullptr;
+
+        if (estimates && aged && survivors == HOT && admitted < NUM / 2 && rejected && late && inactive) {
+            cout << "ADMISSION " << name << " PASSED" << endl;
+        } else {
+            cout << "ADMISSION " << name << " FAILED" << endl;
+        }
+    }
+}
+
+// clock of the time to live tests, moved forward by hand
+static long long fakeTime = 1000;
+long long fakeClock() {
+    return fakeTime;
+}
+
+void Tester::timeToLive() {
+    const int SHORT = 4000;     // people that expire after 100 ms, more than 80% of the table
+    const int LONG = 500;       // people that expire after an hour
+    const int KEEP = 300;       // people without a ttl
+    POLICY policies[] = {PRIME, POWEROFTWO};
+    for (POLICY policy : policies) {
+        string name = policy == PRIME ? "PRIME" : "POWEROFTWO";
+        fakeTime = 1000;
+        Cache cache(MINPRIME, hashCode, policy);
+        cache.m_clock = fakeClock;
+        bool inserted = true;
+        for (int i = 0; i < SHORT; i++) {
+            inserted = inserted && cache.insert(Person("short" + to_string(i), MINID + i), chrono::milliseconds(100));
+        }
+        for (int i = 0; i < LONG; i++) {
+            inserted = inserted && cache.insert(Person("long" + to_string(i), MINID + i), chrono::hours(1));
+        }
+        for (int i = 0; i < KEEP; i++) {
+            inserted = inserted && cache.insert(Person("keep" + to_string(i), MINID + i));
+        }
+        // nothing expires early
+        fakeTime += 99;
+        bool early = cache.getPerson("short0", MINID) == Person("short0", MINID);
+
+        // an expired person is never found again, even before the wheel removes it
+        fakeTime += 1;
+        bool lazy = true;
+        for (int i = 0; i < SHORT; i++) {
+            lazy = lazy && cache.getPerson("short" + to_string(i), MINID + i) == EMPTY;
+        }
+        for (int i = 0; i < LONG; i++) {
+            lazy = lazy && cache.getPerson("long" + to_string(i), MINID + i) == Person("long" + to_string(i), MINID + i);
+        }
+
+        // every operation expires at most EXPIREBUDGET records, and the mass expiry compacts the table
+        int capacity = cache.m_currentCap;
+        bool bounded = true;
+        int operations = 0;
+        while (cache.m_wheelCount > LONG && operations < 10 * SHORT) {
+            int before = cache.m_wheelCount;
+            cache.remove(Person("absent", MINID));
+            bounded = bounded && before - cache.m_wheelCount <= EXPIREBUDGET;
+            operations++;
+        }
+        bool compacted = cache.liveCount() == LONG + KEEP && cache.stats().m_expirations == (unsigned long long)SHORT
+            && operations >= SHORT / EXPIREBUDGET && cache.m_currentCap < capacity;
+
+        // an expired person can be inserted again and an expired person cannot be removed, a person inserted again
+        // with a later deadline is not expired by the record of its first deadline
+        cache.insert(Person("again", MINID), chrono::milliseconds(50));
+        cache.remove(Person("again", MINID));
+        bool again = cache.insert(Person("again", MINID), chrono::milliseconds(500));
+        fakeTime += 100;
+        for (int i = 0; i < 100; i++) {
+            cache.remove(Person("absent", MINID));
+        }
+        again = again && cache.getPerson("again", MINID) == Person("again", MINID);
+        fakeTime += 500;
+        again = again && !cache.remove(Person("again", MINID)) && cache.insert(Person("again", MINID));
+
+        // after a long idle time the long ttls expire too, the wheel catches up within a bounded number of operations
+        fakeTime += 2 * 3600 * 1000;
+        operations = 0;
+        while (cache.m_wheelCount > 0 && operations < 100000) {
+            cache.remove(Person("absent", MINID));
+            operations++;
+        }
+        bool idle = cache.m_wheelCount == 0 && cache.liveCount() == KEEP + 1;
+        for (int i = 0; i < KEEP; i++) {
+            idle = idle && cache.getPerson("keep" + to_string(i), MINID + i) == Person("keep" + to_string(i), MINID + i);
+        }
+
+        // the wheel jumps over empty ticks and blocks: after a 4 hour idle time a person with a 3 hour ttl leaves the
+        // table within a few operations, not one per 64 ms block
+        Cache sparse(MINPRIME, hashCode, policy);
+        sparse.m_clock = fakeClock;
+        sparse.insert(Person("sparse", MINID), chrono::hours(3));
+        fakeTime += 4 * 3600 * 1000;
+        operations = 0;
+        while (sparse.m_wheelCount > 0 && operations < 1000) {
+            sparse.remove(Person("absent", MINID));
+            operations++;
+        }
+        idle = idle && sparse.m_wheelCount == 0 && sparse.liveCount() == 0 && operations <= 2;
+
+        if (inserted && early && lazy && bounded && compacted && again && idle) {
+            cout << "TIME TO LIVE " << name << " PASSED" << endl;
+        } else {
+            cout << "TIME TO LIVE " << name << " FAILED" << endl;
+        }
+    }
+}
+
+void Tester::tableStorage() {
+    // a new table constructs none of its slots, a used slot stays constructed until the table is freed and every
+    // constructed slot is destroyed exactly once, through rehashes and the transfer
+    bool lazy = true;
+    {
+        BasicCache<string, CountedWord, WordHash> cache(MINPRIME);
+        lazy = CountedWord::s_alive == 0;
+        for (int i = 0; i < 10; i++) {
+            cache.insert(CountedWord("word" + to_string(i)));
+        }
+        lazy = lazy && CountedWord::s_alive == 10;
+        cache.remove("word0");
+        lazy = lazy && CountedWord::s_alive == 10 && cache.find("word0") == nullptr;
+        for (int i = 10; i < 2000; i++) {
+            cache.insert(CountedWord("word" + to_string(i)));
+            if (i % 3 == 0) {
+                cache.remove("word" + to_string(i));
+            }
+        }
+    }
+    lazy = lazy && CountedWord::s_alive == 0;
+
+    // every table array starts on a cache line, and the arrays of a large table on a huge page
+    Cache cache(MINPRIME, hashCode, POWEROFTWO);
+    bool aligned = (uintptr_t)cache.m_currentTable % CACHELINE == 0 && (uintptr_t)cache.m_currentCtrl % CACHELINE == 0
+        && (uintptr_t)cache.m_currentHashes % CACHELINE == 0;
+    BasicCache<PersonKey, Person, PersonHash, equal_to<PersonKey>, HugePageAllocator>
+        huge(MAXPOWER / 2, PersonHash{hashCode, nullptr}, POWEROFTWO);
+    aligned = aligned && (size_t)huge.m_currentCap * sizeof(Person) >= HUGEPAGE
+        && (uintptr_t)huge.m_currentTable % HUGEPAGE == 0;
+    bool inserted = true;
+    for (int i = 0; i < 1000; i++) {
+        inserted = inserted && huge.insert(Person("huge" + to_string(i), MINID + i));
+    }
+
+    // a pool allocator hands the tables of a compaction back to the next one of the same size, the tables of a cache
+    // that churns through keys alternate between two blocks
+    BasicCache<PersonKey, Person, PersonHash, equal_to<PersonKey>, PoolAllocator> pool(MINPRIME, PersonHash{hashCode, nullptr});
+    for (int i = 0; i < 10; i++) {
+        pool.insert(Person("pool" + to_string(i), MINID + i));
+    }
+    set<const Person*> tables;
+    int compactions = 0;
+    for (int i = 10; i < 3000; i++) {
+        const Person* before = pool.m_currentTable;
+        pool.insert(Person("pool" + to_string(i), MINID + i % (MAXID - MINID)));
+        pool.remove(PersonKey{"pool" + to_string(i), MINID + i % (MAXID - MINID)});
+        if (pool.m_currentTable != before) {
+            compactions++;
+            tables.insert(pool.m_currentTable);
+        }
+    }
+    bool reused = compactions >= 4 && tables.size() <= 3 && pool.m_allocator.m_count <= POOLBLOCKS;
+    for (int i = 0; i < 10; i++) {
+        reused = reused && pool.find(PersonKey{"pool" + to_string(i), MINID + i}) != nullptr;
+    }
+
+    // the reference counters of a bounded cache and the deadlines of values with a time to live come from the
+    // allocator like the rest of a table, through growth, eviction and expiry, and every byte of them goes back
+    bool counted = true;
+    {
+        BasicCache<string, Word, WordHash, equal_to<string>, CountingAllocator> words(MINPRIME);
+        long long table = CountingAllocator::s_bytes;
+        words.setEvictionLimit(500);
+        counted = CountingAllocator::s_bytes == table + words.m_currentCap;
+        words.insert(Word{"first", 0}, chrono::milliseconds(60000));
+        counted = counted && CountingAllocator::s_bytes == table + words.m_currentCap * (1 + (long long)sizeof(long long));
+        for (int i = 0; i < 2000; i++) {
+            words.insert(Word{"word" + to_string(i), i}, chrono::milliseconds(i % 2 ? 60000 : 1));
+        }
+        words.setEvictionLimit(0);
+    }
+    counted = counted && CountingAllocator::s_bytes == 0;
+
+    if (lazy && aligned && inserted && reused && counted) {
+        cout << "TABLE STORAGE PASSED" << endl;
+    } else {
+        cout << "TABLE STORAGE FAILED" << endl;
+    }
+}
+
+void Tester::keyPool() {
+    // every key is stored once, its handle and bytes never change and a key that was not interned is not found
+    KeyPool pool(hashCode);
+    bool interned = pool.find("c++") == NOKEY && pool.size() == 0;
+    vector<string> keys;
+    vector<unsigned int> handles;
+    for (int i = 0; i < 20000; i++) {
+        keys.push_back(i % 1000 == 0 ? string(ARENABLOCK + i, 'k') : "key" + to_string(i));
+        handles.push_back(pool.intern(keys.back()));
+    }
+    string_view first = pool.key(handles[1]);
+    for (int i = 0; i < 20000; i++) {
+        interned = interned && pool.intern(keys[i]) == handles[i] && pool.find(keys[i]) == handles[i]
+            && pool.key(handles[i]) == keys[i] && pool.hash(handles[i]) == hashCode(keys[i]);
+    }
+    interned = interned && pool.size() == 20000 && first.data() == pool.key(handles[1]).data()
+        && pool.find("key20000") == NOKEY && pool.find("") == NOKEY;
+    interned = interned && pool.intern("") == 20000 && pool.find("") == 20000 && pool.key(20000).empty();
+
+    // the same random operations on a PooledCache and on a Cache, the keys of searchStr are shared by many people,
+    // in both key only and composite hashing. the pool holds each search string once
+    bool same = true;
+    for (int composite = 0; composite < 2; composite++) {
+        combine_fn combine = composite ? combineHash : nullptr;
+        PooledCache pooled(MINPRIME, hashCode, PRIME, combine);
+        Cache cache(MINPRIME, hashCode, PRIME, combine);
+        Random RndID(MINID, MAXID);
+        Random RndStr(MINSEARCH, MAXSEARCH);
+        Random RndOp(0, 2);
+        RndStr.setSeed(11);
+        RndOp.setSeed(12);
+        vector<Person> people;
+        set<string> used;
+        for (int i = 0; i < 20000; i++) {
+            Person person(searchStr[RndStr.getRandNum()], RndID.getRandNum());
+            int op = RndOp.getRandNum();
+            if (op == 0 || people.empty()) {
+                same = (pooled.insert(person) == cache.insert(person)) && same;
+                people.push_back(person);
+                used.insert(person.getKey());
+            } else if (op == 1) {
+                Person old = people[RndID.getRandNum() % people.size()];
+                same = (pooled.remove(old) == cache.remove(old)) && same;
+            } else {
+                Person old = people[RndID.getRandNum() % people.size()];
+                same = same
+                    && pooled.getPerson(old.getKey(), old.getID()) == cache.getPerson(old.getKey(), old.getID());
+            }
+        }
+        for (const Person& person : people) {
+            same = same
+                && pooled.getPerson(person.getKey(), person.getID()) == cache.getPerson(person.getKey(), person.getID());
+        }
+        size_t bytes = 0;
+        for (const string& key : used) {
+            bytes += key.size();
+        }
+        same = same && pooled.keys() == (int)used.size() && pooled.lambda() == cache.lambda()
+            && pooled.m_pool.m_blocks.size() == 1 && pooled.m_pool.m_blockUsed == bytes;
+        // out of range IDs and keys that were never inserted, a miss does not intern its key
+        same = same && !pooled.insert(Person("ruby", MINID - 1)) && !pooled.insert(Person("ruby", MAXID + 1))
+            && pooled.getPerson("go", MINID) == EMPTY && !pooled.remove(Person("go", MINID))
+            && pooled.keys() == (int)used.size();
+    }
+
+    if (interned && same) {
+        cout << "KEY POOL PASSED" << endl;
+    } else {
+        cout << "KEY POOL FAILED" << endl;
+    }
+}
+
+void Tester::packedIds() {
+    // person keys and pooled keys are packed, other keys are not
+    bool packed = PackedKey<PersonKey>::value && PackedKey<PooledKey>::value && !PackedKey<string>::value
+        && WordCache(MINPRIME).m_currentPacked == nullptr;
+
+    // 2000 people share one key and so one hash (key only hashing), every slot keeps the ID of its person in both
+    // tables while the table grows, and a person is only read when its ID matches
+    for (int policy = 0; policy < 2; policy++) {
+        BasicCache<PersonKey, Person, PersonHash, CountingEqual>
+            cache(MINPRIME, PersonHash{hashCode, nullptr}, policy ? POWEROFTWO : PRIME);
+        bool moved = false;
+        for (int id = MINID; id < MINID + 2000; id++) {
+            cache.insert(Person("c++", id));
+            for (int old = 0; old < 2; old++) {
+                const signed char* ctrl = old ? cache.m_oldCtrl : cache.m_currentCtrl;
+                const unsigned short* ids = old ? cache.m_oldPacked : cache.m_currentPacked;
+                const Person* table = old ? cache.m_oldTable : cache.m_currentTable;
+                for (int i = 0; ctrl != nullptr && i < (old ? cache.m_oldCap : cache.m_currentCap); i++) {
+                    packed = packed && (ctrl[i] < 0 || ids[i] == table[i].m_id);
+                }
+                moved = moved || (old && cache.m_oldTable != nullptr);
+            }
+        }
+        CountingEqual::s_compares = 0;
+        for (int id = MINID; id < MINID + 2000; id++) {
+            packed = packed && cache.find(PersonKey{"c++", id}) != nullptr;
+        }
+        packed = packed && CountingEqual::s_compares == 2000 && moved;
+        // a missing ID of the same key, and a removed one, never read a person
+        cache.remove(PersonKey{"c++", MINID});
+        CountingEqual::s_compares = 0;
+        packed = packed && cache.find(PersonKey{"c++", MINID + 2000}) == nullptr
+            && cache.find(PersonKey{"c++", MINID}) == nullptr && CountingEqual::s_compares == 0;
+    }
+
+    if (packed) {
+        cout << "PACKED IDS PASSED" << endl;
+    } else {
+        cout << "PACKED IDS FAILED" << endl;
+    }
+}
+
+// tests tables that grow past MAXPRIME and MAXPOWER with every number still found, the max load of POWEROFTWO mode,
+// hashes that only differ in their high 32 bits, and the capacity helpers up to 2^32
+void Tester::largeTables() {
+    // both policies grow past the largest capacity the constructor gives, insert never rejects on the way
+    const unsigned long long count = 300000;
+    bool grown = true;
+    for (int policy = 0; policy < 2; policy++) {
+        NumberCache cache(MINPRIME, HighHash(), policy ? POWEROFTWO : PRIME);
+        for (unsigned long long i = 0; i < count; i++) {
+            grown = grown && cache.insert(Number{i}) && cache.lambda() <= 0.5;
+        }
+        for (unsigned long long i = 0; i < count; i += 2) {
+            grown = grown && cache.remove(i);
+        }
+        for (unsigned long long i = 0; i < count; i++) {
+            const Number* found = cache.find(i);
+            grown = grown && (i % 2 == 0 ? found == nullptr : found != nullptr && found->m_value == i);
+        }
+        long long cap = cache.m_currentCap;
+        grown = grown && cache.liveCount() == (long long)count / 2 && cap > (policy ? MAXPOWER : MAXPRIME)
+            && (policy ? (cap & (cap - 1)) == 0 : GROWTH.prime[GROWTH.nearest(cap)] == cap);
+        // the hash is folded when it is stored, so the number in the high 32 bits is the stored hash, and a moved
+        // value keeps the fingerprint of its full hash
+        grown = grown && foldHash(cache.hashOf(12345, false)) == 12345;
+        for (long long i = 0; i < cap; i++) {
+            grown = grown && (cache.m_currentCtrl[i] < 0
+                || cache.m_currentCtrl[i] == fingerprint(HighHash()(cache.m_currentTable[i].m_value)));
+        }
+    }
+
+    // the fingerprint takes the high half of a 64-bit hash, so hashes that store the same 32 bits (the same home slot
+    // even in a table of 2^32 slots) still get all fingerprints, while a 32-bit hash keeps its fingerprint
+    set<signed char> tags;
+    for (unsigned long long high = 0; high < 1000; high++) {
+        tags.insert(fingerprint(high << 32 | (high ^ 0xC0FFEE)));
+    }
+    grown = grown && tags.size() == 128 && fingerprint(0xC0FFEEULL) == (signed char)((0xC0FFEEu * 0x85EBCA6Bu) >> 25);
+
+    // a POWEROFTWO table with a max load of 0.875 holds the numbers in half the slots (2^19 instead of 2^20), also
+    // while a migration budget spreads every transfer over many inserts
+    NumberCache dense(MINPRIME, HighHash(), POWEROFTWO);
+    dense.setMaxLoad(0.875);
+    dense.setMigrationBudget(64);
+    bool load = true;
+    for (unsigned long long i = 0; i < count; i++) {
+        load = load && dense.insert(Number{i}) && dense.lambda() <= 0.875;
+    }
+    for (unsigned long long i = 0; i < count; i++) {
+        load = load && dense.find(i) != nullptr;
+    }
+    load = load && dense.m_currentCap == 524288;
+    // the max load is clamped to what the policy allows
+    NumberCache prime(MINPRIME, HighHash(), PRIME);
+    prime.setMaxLoad(0.875);
+    dense.setMaxLoad(1);
+    load = load && prime.m_maxLoad == 0.5f && dense.m_maxLoad == MAXGROWLOAD;
+
+    // capacities go up to the largest prime below 2^32 and to 2^32, where home still takes the top bits of the hash
+    Cache cache(MINPRIME, hashCode);
+    Cache power(MINPRIME, hashCode, POWEROFTWO);
+    bool limits = cache.findNextPrime(MAXPRIME) == 100003 && cache.findNextPrime(MAXGROWPRIME - 10) == MAXGROWPRIME
+        && cache.findNextPrime(MAXGROWPRIME) == MAXGROWPRIME && cache.isPrime(MAXGROWPRIME)
+        && !cache.isPrime(MAXGROWPOWER - 1) && power.findNextPowerOfTwo(MAXGROWPOWER * 4) == MAXGROWPOWER;
+    // the growth primes roughly double up to MAXGROWPRIME and come with their reciprocals, a table that went past its
+    // max load grows to the next one
+    limits = limits && GROWTH.prime[0] == MINPRIME && GROWTH.prime[GROWTHPRIMES - 1] == MAXGROWPRIME
+        && GROWTH.nearest(2 * 1779761 + 4) == 15 && GROWTH.nearest(MAXGROWPRIME * 2) == GROWTHPRIMES - 1;
+    for (int i = 0; i < GROWTHPRIMES; i++) {
+        limits = limits && cache.isPrime(GROWTH.prime[i]) && GROWTH.magic[i] == magic(GROWTH.prime[i])
+            && (i == 0 || (GROWTH.prime[i] > 2 * GROWTH.prime[i - 1] - 2 * MINPRIME
+            && GROWTH.prime[i] < 2 * GROWTH.prime[i - 1] + 2 * MINPRIME) || i == GROWTHPRIMES - 1);
+    }
+    long long cap = power.m_currentCap;
+    power.m_currentCap = MAXGROWPOWER;
+    limits = limits && power.home(0xFFFFFFFFu, false) == (unsigned int)(0xFFFFFFFFu * 0x9E3779B9u);
+    power.m_currentCap = cap;
+
+    if (grown && load && limits) {
+        cout << "LARGE TABLES PASSED" << endl;
+    } else {
+        cout << "LARGE TABLES FAILED" << endl;
+    }
+}
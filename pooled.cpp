@@ -0,0 +1,159 @@
+#include "pooled.h"
+
+template class BasicCache<PooledKey, PooledPerson, PooledHash>;
+
+const int MININDEX = 16;    // slots of the index of an empty pool
+
+// returns the slot a probe sequence for hash starts at in an index of size slots (a power of two), taken from the top
+// bits of a multiplicative (fibonacci) hash like in RobinHoodCache
+static inline int home(unsigned int hash, int size){
+    return (hash * 0x9E3779B9u) >> (32 - __builtin_ctz(size));
+}
+
+// KeyPool object constructor, the arena gets its first block with the first key
+KeyPool::KeyPool(hash_fn hash){
+    m_hash = hash;
+    m_blockUsed = 0;
+    m_index.assign(MININDEX, 0);
+}
+
+// returns the handle of key, a new key is copied into the arena and gets the next handle
+unsigned int KeyPool::intern(string_view key){
+    unsigned int hash = m_hash(string(key));
+    int slot = lookup(key, hash);
+    if (m_index[slot] != 0){
+        return m_index[slot] - 1;
+    }
+    unsigned int handle = m_records.size();
+    m_records.push_back(Record{store(key), (unsigned int)key.size(), hash});
+    m_index[slot] = handle + 1;
+    // keeps the index at most half full
+    if (m_records.size() * 2 > m_index.size()){
+        grow();
+    }
+    return handle;
+}
+
+// an empty slot holds 0, so a key that is not found gives NOKEY
+unsigned int KeyPool::find(string_view key) const {
+    int slot = lookup(key, m_hash(string(key)));
+    return m_index[slot] - 1;
+}
+
+int KeyPool::size() const {
+    return m_records.size();
+}
+
+size_t KeyPool::bytes() const {
+    size_t bytes = m_records.capacity() * sizeof(Record) + m_index.capacity() * sizeof(unsigned int);
+    for (size_t size : m_blockSizes){
+        bytes += size;
+    }
+    return bytes;
+}
+
+// helper function, probes the index linearly from the slot of hash until it finds key or an empty slot. the stored
+// hashes are compared first, so the bytes of a key are only read when the hash matches
+int KeyPool::lookup(string_view key, unsigned int hash) const {
+    int mask = m_index.size() - 1;
+    int slot = home(hash, m_index.size());
+    while (m_index[slot] != 0){
+        const Record& record = m_records[m_index[slot] - 1];
+        if (record.m_hash == hash && string_view(record.m_bytes, record.m_length) == key){
+            return slot;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+// helper function, appends the bytes of key to the last block, or to a new block if they do not fit. a key longer than
+// ARENABLOCK gets a block of its own
+const char* KeyPool::store(string_view key){
+    if (m_blocks.empty() || m_blockUsed + key.size() > m_blockSizes.back()){
+        size_t size = key.size() > ARENABLOCK ? key.size() : ARENABLOCK;
+        m_blocks.emplace_back(new char[size]);
+        m_blockSizes.push_back(size);
+        m_blockUsed = 0;
+    }
+    char* bytes = m_blocks.back().get() + m_blockUsed;
+    key.copy(bytes, key.size());
+    m_blockUsed += key.size();
+    return bytes;
+}
+
+// helper function, doubles the index and puts every handle back with its stored hash, no key is hashed again
+void KeyPool::grow(){
+    vector<unsigned int> index(m_index.size() * 2, 0);
+    int mask = index.size() - 1;
+    for (unsigned int entry : m_index){
+        if (entry != 0){
+            int slot = home(m_records[entry - 1].m_hash, index.size());
+            while (index[slot] != 0){
+                slot = (slot + 1) & mask;
+            }
+            index[slot] = entry;
+        }
+    }
+    m_index.swap(index);
+}
+
+// PooledCache object constructor, the hasher of the table reads the key hashes from the pool
+PooledCache::PooledCache(int size, hash_fn hash, POLICY policy, combine_fn combine)
+    : m_pool(hash), m_cache(size, PooledHash{&m_pool, combine}, policy){
+}
+
+float PooledCache::lambda() const {
+    return m_cache.lambda();
+}
+
+float PooledCache::deletedRatio() const {
+    return m_cache.deletedRatio();
+}
+
+// inserts object into cache object, checks if the ID of the person object is in between MINID and MAXID. the key is
+// interned even if the insert fails
+bool PooledCache::insert(const Person& person){
+    if (person.getID() < MINID || person.getID() > MAXID){
+        return false;
+    }
+    return m_cache.insert(PooledPerson{m_pool.intern(keyOf(person).m_key), person.getID()});
+}
+
+// removes a person object if it exists, a key that is not in the pool was never inserted
+bool PooledCache::remove(const Person& person){
+    unsigned int handle = m_pool.find(keyOf(person).m_key);
+    if (handle == NOKEY){
+        return false;
+    }
+    return m_cache.remove(PooledKey{handle, person.getID()});
+}
+
+// returns the person object if found, builds it from the string in the pool. returns an empty person object if not
+// found
+Person PooledCache::getPerson(string_view key, int id) const{
+    unsigned int handle = m_pool.find(key);
+    if (handle != NOKEY && m_cache.find(PooledKey{handle, id}) != nullptr){
+        return Person(string(m_pool.key(handle)), id);
+    }
+    return Person();
+}
+
+int PooledCache::keys() const {
+    return m_pool.size();
+}
+
+// dumps the tables (handles and IDs) and then the string of every handle
+void PooledCache::dump() const {
+    m_cache.dump();
+    cout << "Dump for the key pool: " << endl;
+    for (int i = 0; i < m_pool.size(); i++){
+        cout << "#" << i << " : " << m_pool.key(i) << endl;
+    }
+}
+
+ostream& operator<<(ostream& sout, const PooledPerson& person){
+    if (person.m_key != NOKEY)
+        sout << "#" << person.m_key << " (ID " << person.m_id << ")";
+    return sout;
+}
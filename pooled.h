@@ -0,0 +1,132 @@
+#ifndef POOLED_H
+#define POOLED_H
+#include "cache.h"
+#include <memory>
+#include <vector>
+class Tester;       // forward declaration, will be used for testing
+class KeyPool;      // forward declaration
+class PooledCache;  // forward declaration
+
+const unsigned int NOKEY = 0xFFFFFFFF;  // handle of a key that is not in the pool
+const size_t ARENABLOCK = 64 * 1024;    // bytes of each block of the key arena, a longer key gets a block of its own
+
+// dictionary of search strings, every distinct string is stored once and identified by a 32-bit handle
+// the bytes of the strings are appended to an arena of ARENABLOCK blocks that never move, so a string_view of a key
+// stays valid as long as the pool. the index from string to handle is open addressing with linear probing over a
+// power of two table of handles, at most half full, and the hash of every string is kept so it is hashed only once
+// a pool only grows, a key stays in it after the last person with it was removed
+class KeyPool{
+public:
+    friend class Tester;
+    KeyPool(hash_fn hash);
+    KeyPool(const KeyPool&) = delete;
+    KeyPool& operator=(const KeyPool&) = delete;
+    // returns the handle of key, adds it to the pool first if it is not in it
+    unsigned int intern(string_view key);
+    // returns the handle of key, or NOKEY if it is not in the pool
+    unsigned int find(string_view key) const;
+    // returns the string of a handle
+    string_view key(unsigned int handle) const {
+        return string_view(m_records[handle].m_bytes, m_records[handle].m_length);
+    }
+    // returns the hash_fn hash of the string of a handle
+    unsigned int hash(unsigned int handle) const {
+        return m_records[handle].m_hash;
+    }
+    // returns the number of keys in the pool
+    int size() const;
+    // returns the bytes held by the pool, arena blocks, records and index
+    size_t bytes() const;
+
+private:
+    // one key, where its bytes are in the arena and its hash
+    struct Record{
+        const char* m_bytes;
+        unsigned int m_length;
+        unsigned int m_hash;
+    };
+
+    hash_fn     m_hash;         // hash function
+    vector<unique_ptr<char[]>> m_blocks;// arena blocks, the last one is filled
+    vector<size_t> m_blockSizes;// size of each block
+    size_t      m_blockUsed;    // bytes used in the last block
+    vector<Record> m_records;   // record of each handle
+    vector<unsigned int> m_index;// handle + 1 of the key in each slot, 0 for an empty slot
+
+    //private helper functions
+    int lookup(string_view, unsigned int) const; // slot of a key in the index, or the empty slot it would go in
+    const char* store(string_view); // copies the bytes of a key into the arena
+    void grow(); // doubles the index
+};
+
+// key of a PooledPerson, the handle of its search string and its ID. two keys are equal if both numbers are
+struct PooledKey{
+    unsigned int m_key;
+    int m_id;
+};
+inline bool operator==(const PooledKey& lhs, const PooledKey& rhs){
+    return lhs.m_key == rhs.m_key && lhs.m_id == rhs.m_id;
+}
+
+// returns the ID of a key, compared before a slot is read like the IDs of a Cache
+inline unsigned short packedOf(const PooledKey& key){
+    return (unsigned short)key.m_id;
+}
+
+// a person stored in a PooledCache, 8 bytes instead of the string and ID of a Person
+struct PooledPerson{
+    unsigned int m_key = NOKEY; // handle of the search string in the KeyPool of the cache
+    int m_id = 0;               // a unique ID number identifying the object
+};
+inline PooledKey keyOf(const PooledPerson& person){
+    return PooledKey{person.m_key, person.m_id};
+}
+// prints the handle of the key and the ID, PooledCache::dump prints the strings
+ostream& operator<<(ostream& sout, const PooledPerson& person);
+
+// hash of a PooledKey, the hash_fn hash the pool keeps for the key, combined with the ID if combine is not null
+// nothing is hashed again, a lookup only hashes its search string once to find the handle
+struct PooledHash{
+    const KeyPool* m_pool;      // pool of the cache
+    combine_fn  m_combine;      // combines the key hash with the ID, nullptr if only the key is hashed
+    unsigned long long operator()(const PooledKey& key) const {
+        unsigned int hash = m_pool->hash(key.m_key);
+        return m_combine != nullptr ? m_combine(hash, key.m_id) : hash;
+    }
+};
+
+// BasicCache for pooled people, built once in pooled.cpp
+extern template class BasicCache<PooledKey, PooledPerson, PooledHash>;
+
+// cache with the insert/remove/getPerson interface of Cache that stores every search string once in a KeyPool
+// (dictionary encoding). a slot holds the handle of the key and the ID, so people that share a key share its bytes, a
+// long key costs one heap allocation in total instead of one per person, and comparing keys in the probe loop is a
+// compare of two integers. getPerson finds the handle of its key in the pool first, a key that was never inserted is
+// a miss without probing the table at all
+// not thread safe, and a PooledCache cannot be copied (its hasher points to its pool)
+class PooledCache{
+public:
+    friend class Tester;
+    // combine works like in Cache, composite hashing of key and ID if it is not null
+    PooledCache(int size, hash_fn hash, POLICY policy = PRIME, combine_fn combine = nullptr);
+    PooledCache(const PooledCache&) = delete;
+    PooledCache& operator=(const PooledCache&) = delete;
+    // Returns Load factor of the new table
+    float lambda() const;
+    // Returns the ratio of deleted slots in the new table
+    float deletedRatio() const;
+    // interns the key of person and inserts it, only people with an ID in [MINID-MAXID] are inserted
+    bool insert(const Person& person);
+    // remove can happen from either table
+    bool remove(const Person& person);
+    // returns a copy of the person or an empty person object
+    Person getPerson(string_view key, int id) const;
+    // returns the number of distinct keys inserted so far
+    int keys() const;
+    void dump() const;
+
+private:
+    KeyPool     m_pool;         // search strings, before m_cache so it is built first
+    BasicCache<PooledKey, PooledPerson, PooledHash> m_cache;// handles and IDs
+};
+#endif
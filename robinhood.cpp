@@ -0,0 +1,276 @@
+#include "robinhood.h"
+
+const float MAXLOAD = 0.8; // load factor that triggers a rehash, Robin Hood probing stays short up to high loads
+
+// returns the slot a probe sequence for hash starts at in a table of capacity cap (a power of two), taken from the
+// top bits of a multiplicative (fibonacci) hash
+static inline int home(unsigned int hash, int cap){
+    return (hash * 0x9E3779B9u) >> (32 - __builtin_ctz(cap));
+}
+
+// RobinHoodCache object constructor, rounds the size up to a power of two and makes the current table
+RobinHoodCache::RobinHoodCache(int size, hash_fn hash, combine_fn combine){
+    m_hash = hash;
+    m_combine = combine;
+    m_currentCap = findNextPowerOfTwo(size);
+    m_currentSize = 0;
+    m_currentTable = new Person[m_currentCap];
+    m_currentDist = new int[m_currentCap]();
+    m_currentHashes = new unsigned int[m_currentCap];
+
+    // sets old variables to 0/nullptr
+    m_oldTable = nullptr;
+    m_oldDist = nullptr;
+    m_oldHashes = nullptr;
+    m_oldCap = 0;
+    m_oldSize = 0;
+    m_oldQuota = 0;
+    m_cursor = 0;
+}
+
+// RobinHoodCache destructor, deallocates memory
+RobinHoodCache::~RobinHoodCache(){
+    delete [] m_currentTable;
+    delete [] m_currentDist;
+    delete [] m_currentHashes;
+    deleteOld();
+    m_currentTable = nullptr;
+    m_currentDist = nullptr;
+    m_currentHashes = nullptr;
+    m_currentCap = 0;
+    m_currentSize = 0;
+    m_hash = nullptr;
+    m_combine = nullptr;
+}
+
+float RobinHoodCache::lambda() const {
+    return float(m_currentSize) / float(m_currentCap);
+}
+
+float RobinHoodCache::deletedRatio() const {
+    return 0;
+}
+
+// inserts object into the cache object if it is not already there. transfers part of the old table after every
+// insertion and rehashes if lambda > MAXLOAD
+bool RobinHoodCache::insert(Person person){
+    // checks if person object is in between MINID and MAXID and if there is room (MAXPRIME case like Cache)
+    if (person.getID() < MINID || person.getID() > MAXID || m_currentSize + m_oldSize >= MAXPRIME/2){
+        return false;
+    }
+    // checks if the person object has already been inserted before
+    unsigned int hash = hashOf(person.getKey(), person.getID());
+    if (findIndex(false, hash, person.getKey(), person.getID()) != -1
+    || findIndex(true, hash, person.getKey(), person.getID()) != -1){
+        return false;
+    }
+
+    place(person, hash);
+    if (m_oldTable != nullptr){
+        fillUpTable();
+    }
+    if (lambda() > MAXLOAD && m_oldTable == nullptr && m_currentCap < MAXPOWER){
+        reHash();
+    }
+    return true;
+}
+
+// removes a person object from whichever table it is in. the slot is emptied by shifting the rest of its cluster back
+bool RobinHoodCache::remove(Person person){
+    bool removed = false;
+    unsigned int hash = hashOf(person.getKey(), person.getID());
+    int h = findIndex(false, hash, person.getKey(), person.getID());
+    if (h != -1){
+        shiftBack(false, h);
+        removed = true;
+    }else{
+        h = findIndex(true, hash, person.getKey(), person.getID());
+        if (h != -1){
+            shiftBack(true, h);
+            removed = true;
+        }
+    }
+    if (m_oldTable != nullptr){
+        fillUpTable();
+    }
+    return removed;
+}
+
+// returns the person object if found in either table, else returns an empty person object
+Person RobinHoodCache::getPerson(string key, int id) const {
+    const Person* person = find(key, id);
+    if (person != nullptr){
+        return *person;
+    }
+    return Person();
+}
+
+// returns a pointer to the person object if found in either table, else returns nullptr
+const Person* RobinHoodCache::find(string_view key, int id) const {
+    unsigned int hash = hashOf(key, id);
+    int h = findIndex(false, hash, key, id);
+    if (h != -1){
+        return &m_currentTable[h];
+    }
+    h = findIndex(true, hash, key, id);
+    if (h != -1){
+        return &m_oldTable[h];
+    }
+    return nullptr;
+}
+
+void RobinHoodCache::dump() const {
+    cout << "Dump for the current table: " << endl;
+    for (int i = 0; i < m_currentCap; i++) {
+        cout << "[" << i << "] : ";
+        if (m_currentDist[i] != 0)
+            cout << m_currentTable[i];
+        cout << endl;
+    }
+    cout << "Dump for the old table: " << endl;
+    if (m_oldTable != nullptr)
+        for (int i = 0; i < m_oldCap; i++) {
+            cout << "[" << i << "] : ";
+            if (m_oldDist[i] != 0)
+                cout << m_oldTable[i];
+            cout << endl;
+        }
+}
+
+// helper function, returns the smallest power of two that is at least current, in the range [MINPRIME-MAXPOWER]
+int RobinHoodCache::findNextPowerOfTwo(int current){
+    int power = 1;
+    while (power < current || power < MINPRIME){
+        power <<= 1;
+    }
+    return power < MAXPOWER ? power : MAXPOWER;
+}
+
+// helper function, returns the hash of a person, the hash of its key combined with its ID in composite hashing mode
+unsigned int RobinHoodCache::hashOf(string_view key, int id) const {
+    unsigned int hash = m_hash(string(key));
+    return m_combine != nullptr ? m_combine(hash, id) : hash;
+}
+
+// helper function, returns the index of the person with the given key, id and hash in the current or old table, or -1
+// a miss ends at the first slot whose entry is closer to its home than the probe is, since an insert would have
+// displaced that entry
+int RobinHoodCache::findIndex(bool old, unsigned int hash, string_view key, int id) const {
+    const Person* table = old ? m_oldTable : m_currentTable;
+    const int* dist = old ? m_oldDist : m_currentDist;
+    const unsigned int* hashes = old ? m_oldHashes : m_currentHashes;
+    int cap = old ? m_oldCap : m_currentCap;
+    if (table == nullptr){
+        return -1;
+    }
+
+    int h = home(hash, cap);
+    for (int d = 1; dist[h] >= d; d++){
+        if (hashes[h] == hash && table[h].m_id == id && table[h].m_key == key){
+            return h;
+        }
+        h = (h + 1) & (cap - 1);
+    }
+    return -1;
+}
+
+// helper function, Robin Hood insert of a person into the current table. walking from its home slot, the person takes
+// the first slot whose entry is closer to its own home, and the displaced entry continues the walk in its place
+void RobinHoodCache::place(const Person& person, unsigned int hash){
+    Person carry = person;
+    int d = 1;
+    int h = home(hash, m_currentCap);
+    while (m_currentDist[h] != 0){
+        if (m_currentDist[h] < d){
+            // swapping the strings moves the keys without copying them
+            m_currentTable[h].m_key.swap(carry.m_key);
+            swap(m_currentTable[h].m_id, carry.m_id);
+            swap(m_currentHashes[h], hash);
+            swap(m_currentDist[h], d);
+        }
+        h = (h + 1) & (m_currentCap - 1);
+        d++;
+    }
+    m_currentTable[h].m_key.swap(carry.m_key);
+    m_currentTable[h].m_id = carry.m_id;
+    m_currentHashes[h] = hash;
+    m_currentDist[h] = d;
+    m_currentSize++;
+}
+
+// helper function, removes the entry at index of the current or old table. every following entry of the cluster that
+// is not in its home slot moves back by one slot, which keeps the table free of deleted slots
+void RobinHoodCache::shiftBack(bool old, int index){
+    Person* table = old ? m_oldTable : m_currentTable;
+    int* dist = old ? m_oldDist : m_currentDist;
+    unsigned int* hashes = old ? m_oldHashes : m_currentHashes;
+    int cap = old ? m_oldCap : m_currentCap;
+
+    int next = (index + 1) & (cap - 1);
+    while (dist[next] > 1){
+        table[index].m_key.swap(table[next].m_key);
+        table[index].m_id = table[next].m_id;
+        hashes[index] = hashes[next];
+        dist[index] = dist[next] - 1;
+        index = next;
+        next = (next + 1) & (cap - 1);
+    }
+    dist[index] = 0;
+    if (old){
+        m_oldSize--;
+    }else{
+        m_currentSize--;
+    }
+}
+
+// helper function, transfers up to m_oldQuota entries (25% of the old table) from the old table to the current table
+// entries are taken at m_cursor and removed with shiftBack, which only moves entries from after m_cursor back onto
+// it, so every slot before m_cursor stays empty and the old table stays a valid Robin Hood table for lookups
+void RobinHoodCache::fillUpTable(){
+    int moved = 0;
+    while (moved < m_oldQuota && m_oldSize > 0){
+        if (m_oldDist[m_cursor] == 0){
+            m_cursor++;
+        }else{
+            place(m_oldTable[m_cursor], m_oldHashes[m_cursor]);
+            shiftBack(true, m_cursor);
+            moved++;
+        }
+    }
+    if (m_oldSize == 0){
+        deleteOld();
+    }
+}
+
+// helper function, the current table becomes the old table and a new current table with room for twice the entries
+// is made, then the first 25% of the entries are transferred
+void RobinHoodCache::reHash(){
+    m_oldTable = m_currentTable;
+    m_oldDist = m_currentDist;
+    m_oldHashes = m_currentHashes;
+    m_oldCap = m_currentCap;
+    m_oldSize = m_currentSize;
+    m_oldQuota = m_oldSize / 4 > 0 ? m_oldSize / 4 : 1;
+    m_cursor = 0;
+
+    m_currentCap = findNextPowerOfTwo(m_oldSize * 2);
+    m_currentSize = 0;
+    m_currentTable = new Person[m_currentCap];
+    m_currentDist = new int[m_currentCap]();
+    m_currentHashes = new unsigned int[m_currentCap];
+    fillUpTable();
+}
+
+// helper function, deallocates old variables
+void RobinHoodCache::deleteOld(){
+    delete [] m_oldTable;
+    delete [] m_oldDist;
+    delete [] m_oldHashes;
+    m_oldTable = nullptr;
+    m_oldDist = nullptr;
+    m_oldHashes = nullptr;
+    m_oldCap = 0;
+    m_oldSize = 0;
+    m_oldQuota = 0;
+    m_cursor = 0;
+}
@@ -0,0 +1,60 @@
+#ifndef ROBINHOOD_H
+#define ROBINHOOD_H
+#include "cache.h"
+class Tester;           // forward declaration, will be used for testing
+class RobinHoodCache;   // forward declaration
+
+// Robin Hood hash table with the same interface as Cache, so either one can be used for the same workload
+// linear probing over a power of two table, where an insert takes the slot of any entry that is closer to its home
+// slot than the inserted one (so probe lengths stay short and even) and a remove shifts the rest of the cluster back
+// by one slot instead of leaving a deleted slot. there are no deleted slots at all, so deletedRatio() is always 0
+// rehashing is incremental like in Cache, the old table is drained into the new one over the next operations
+class RobinHoodCache{
+public:
+    friend class Tester;
+    // combine works like in Cache, composite hashing of key and ID if it is not null
+    RobinHoodCache(int size, hash_fn hash, combine_fn combine = nullptr);
+    ~RobinHoodCache();
+    // Returns Load factor of the new table
+    float lambda() const;
+    // Returns the ratio of deleted slots in the new table (always 0)
+    float deletedRatio() const;
+    // insert only happens in the new table
+    bool insert(Person person);
+    // remove can happen from either table
+    bool remove(Person person);
+    // find can happen in either table
+    Person getPerson(string key, int id) const;
+    // like getPerson without copying the person, returns nullptr if it is not found (see Cache::find)
+    const Person* find(string_view key, int id) const;
+    void dump() const;
+
+private:
+    hash_fn     m_hash;         // hash function
+    combine_fn  m_combine;      // combines the key hash with the ID, nullptr if only the key is hashed
+
+    Person*     m_currentTable; // hash table
+    int*        m_currentDist;  // probe distance + 1 of the person in each slot, 0 for an empty slot
+    unsigned int* m_currentHashes;// hash of the person in each slot
+    int         m_currentCap;   // hash table size (capacity), a power of two
+    int         m_currentSize;  // current number of entries
+
+    Person*     m_oldTable;     // hash table
+    int*        m_oldDist;      // probe distance + 1 of the person in each slot, 0 for an empty slot
+    unsigned int* m_oldHashes;  // hash of the person in each slot
+    int         m_oldCap;       // hash table size (capacity)
+    int         m_oldSize;      // current number of entries
+    int         m_oldQuota;     // number of entries transferred by each operation while the old table exists
+    int         m_cursor;       // every slot of the old table before m_cursor is empty
+
+    //private helper functions
+    int findNextPowerOfTwo(int current); // helper function to calculate the table capacity
+    unsigned int hashOf(string_view, int) const; // hash of a person, composite if m_combine is set
+    int findIndex(bool, unsigned int, string_view, int) const; // finds a person in the current or old table
+    void place(const Person&, unsigned int); // Robin Hood insert into the current table
+    void shiftBack(bool, int); // backward shift deletion of a slot in the current or old table
+    void fillUpTable(); // helper function used to transfer nodes
+    void reHash(); // helper function to perform rehash operation
+    void deleteOld(); // deallocates old table
+};
+#endif
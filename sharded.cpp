@@ -0,0 +1,67 @@
+#include "sharded.h"
+
+// ShardedCache object constructor, makes the shards with an equal share of the capacity
+ShardedCache::ShardedCache(int size, hash_fn hash, int shards, POLICY policy, combine_fn combine){
+    m_hash = hash;
+    int count = 1;
+    m_shift = 32;
+    while (count < shards && count < MAXSHARDS){
+        count <<= 1;
+        m_shift--;
+    }
+    for (int i = 0; i < count; i++){
+        m_shards.push_back(unique_ptr<Shard>(new Shard(size / count, hash, policy, combine)));
+    }
+}
+
+// inserts object into the shard of the person, only that shard is locked
+bool ShardedCache::insert(Person person){
+    Shard& shard = shardOf(person.getKey(), person.getID());
+    lock_guard<mutex> lock(shard.m_lock);
+    return shard.m_cache.insert(std::move(person));
+}
+
+// removes a person object from its shard if it exists
+bool ShardedCache::remove(Person person){
+    Shard& shard = shardOf(person.getKey(), person.getID());
+    lock_guard<mutex> lock(shard.m_lock);
+    return shard.m_cache.remove(std::move(person));
+}
+
+// returns the person object if found in its shard, else returns an empty person object
+Person ShardedCache::getPerson(string key, int id) const {
+    Shard& shard = shardOf(key, id);
+    lock_guard<mutex> lock(shard.m_lock);
+    const Person* person = shard.m_cache.find(key, id);
+    if (person != nullptr){
+        return *person;
+    }
+    return Person();
+}
+
+float ShardedCache::lambda() const {
+    float total = 0;
+    for (const unique_ptr<Shard>& shard : m_shards){
+        lock_guard<mutex> lock(shard->m_lock);
+        total += shard->m_cache.lambda();
+    }
+    return total / m_shards.size();
+}
+
+void ShardedCache::dump() const {
+    for (unsigned int i = 0; i < m_shards.size(); i++){
+        lock_guard<mutex> lock(m_shards[i]->m_lock);
+        cout << "Dump for shard " << i << ": " << endl;
+        m_shards[i]->m_cache.dump();
+    }
+}
+
+// helper function, returns the shard of the person with the given key and ID. the top bits of the composite hash pick
+// the shard, the shards themselves start probing from the low bits (PRIME) or a multiplicative hash (POWEROFTWO), so
+// sharing the top bits does not crowd the people of one shard together
+ShardedCache::Shard& ShardedCache::shardOf(const string& key, int id) const {
+    if (m_shift == 32){
+        return *m_shards[0];
+    }
+    return *m_shards[(unsigned int)combineHash(m_hash(key), id) >> m_shift];
+}
@@ -0,0 +1,48 @@
+#ifndef SHARDED_H
+#define SHARDED_H
+#include "cache.h"
+#include <memory>
+#include <mutex>
+#include <vector>
+class Tester;       // forward declaration, will be used for testing
+class ShardedCache; // forward declaration
+
+const int MAXSHARDS = 256;  // most shards a ShardedCache can have
+
+// thread-safe cache with the same insert/remove/getPerson interface as Cache, split into independent Cache shards
+// a person always goes to the same shard, picked by the high bits of the hash of its key combined with its ID, so the
+// many IDs of a popular key are spread over all shards. every shard has its own lock and rehashes on its own, so
+// threads working on different shards never wait for each other and a rehash only stalls one shard
+// the shards hash like Cache (key only unless combine is given), the shard itself is always picked by the composite
+// hash
+class ShardedCache{
+public:
+    friend class Tester;
+    // size is the total starting capacity, split evenly over the shards. shards is rounded up to a power of two
+    ShardedCache(int size, hash_fn hash, int shards = 16, POLICY policy = PRIME, combine_fn combine = nullptr);
+    // inserts person into its shard
+    bool insert(Person person);
+    // removes person from its shard
+    bool remove(Person person);
+    // returns a copy of the person, the pointer of Cache::find would not be safe once the lock is released
+    Person getPerson(string key, int id) const;
+    // Returns the load factor of all shards together
+    float lambda() const;
+    void dump() const;
+
+private:
+    // one shard, on its own cache line so the locks of two shards are never in the same line
+    struct alignas(64) Shard{
+        mutable mutex m_lock;   // guards m_cache
+        Cache m_cache;          // entries of this shard
+        Shard(int size, hash_fn hash, POLICY policy, combine_fn combine) : m_cache(size, hash, policy, combine){}
+    };
+
+    hash_fn     m_hash;         // hash function, also used to pick the shard
+    int         m_shift;        // 32 - log2 of the number of shards, the hash is shifted right by it to get the shard
+    vector<unique_ptr<Shard>> m_shards;
+
+    //private helper functions
+    Shard& shardOf(const string&, int) const; // shard of a person
+};
+#endif
@@ -0,0 +1,121 @@
+#ifndef SKETCH_H
+#define SKETCH_H
+#include <cstdint>
+#include <vector>
+using namespace std;
+class Tester;   // forward declaration, will be used for testing
+
+const int SKETCHDEPTH = 4;      // rows of the count-min sketch, each with its own counter for a hash
+const int MAXFREQUENCY = 15;    // largest 4-bit counter
+const int SAMPLEFACTOR = 10;    // the counters are halved after SAMPLEFACTOR times as many increments as there are
+                                // values in the cache
+// most counters in a row, the doorkeeper takes 3 more bits of the 32-bit hashes than a row does
+const size_t MAXSKETCHWIDTH = size_t(1) << 29;
+// multipliers of the multiply-shift hash of each row and of the two doorkeeper bits, odd 32-bit numbers
+const unsigned int ROWMULTIPLIERS[SKETCHDEPTH + 2] = {0x9E3779B1u, 0x85EBCA77u, 0xC2B2AE3Du, 0x27D4EB2Fu,
+                                                      0x165667B1u, 0xD3A2646Du};
+
+// frequency estimate of hashes for the TinyLFU admission policy of a bounded BasicCache (see setAdmission)
+// a count-min sketch with SKETCHDEPTH rows of 4-bit counters, 16 of them packed in each 64-bit word, estimates how
+// often a hash was recorded as the smallest of its counters, so collisions can only make an estimate too high. a
+// doorkeeper bloom filter in front of it takes the first record of a hash, so the many hashes that are only seen once
+// never touch the counters. the sketch ages: after SAMPLEFACTOR records per cache value every counter is halved and
+// the doorkeeper is cleared, so a value that was popular a long time ago does not keep out the values popular now
+// header only like hashers.h, BasicCache is a template and every user of it includes this file
+class FrequencySketch{
+public:
+    friend class Tester;
+    // sized for a cache of entries values, every row has a power of two number of counters, at least entries (up to
+    // MAXSKETCHWIDTH)
+    FrequencySketch(long long entries){
+        m_shift = 32;
+        size_t width = 1;
+        while ((width < (unsigned long long)entries || width < 16) && width < MAXSKETCHWIDTH){
+            width <<= 1;
+            m_shift--;
+        }
+        m_width = width;
+        m_counters.assign(SKETCHDEPTH * width / 16, 0);
+        // 8 doorkeeper bits per counter of a row, two of them per hash
+        m_doorkeeper.assign(width / 8, 0);
+        m_samples = 0;
+        m_sampleSize = SAMPLEFACTOR * (uint64_t)entries;
+    }
+    // records one access of a hash
+    void record(unsigned int hash){
+        unsigned int bits[2];
+        doorkeeperBits(hash, bits);
+        bool seen = true;
+        for (unsigned int bit : bits){
+            unsigned long long mask = 1ULL << (bit & 63);
+            seen = seen && (m_doorkeeper[bit >> 6] & mask);
+            m_doorkeeper[bit >> 6] |= mask;
+        }
+        if (!seen){
+            return;
+        }
+        // counts up the counter of every row that is not full
+        bool added = false;
+        for (int row = 0; row < SKETCHDEPTH; row++){
+            int counter = index(hash, row);
+            unsigned long long& word = m_counters[row * (m_width / 16) + (counter >> 4)];
+            int shift = (counter & 15) * 4;
+            if (((word >> shift) & MAXFREQUENCY) < (unsigned int)MAXFREQUENCY){
+                word += 1ULL << shift;
+                added = true;
+            }
+        }
+        if (added && ++m_samples >= m_sampleSize){
+            age();
+        }
+    }
+    // returns the estimated number of accesses of a hash since the last aging, at most MAXFREQUENCY + 1
+    int frequency(unsigned int hash) const {
+        int estimate = MAXFREQUENCY;
+        for (int row = 0; row < SKETCHDEPTH; row++){
+            int counter = index(hash, row);
+            unsigned long long word = m_counters[row * (m_width / 16) + (counter >> 4)];
+            int value = (word >> ((counter & 15) * 4)) & MAXFREQUENCY;
+            estimate = value < estimate ? value : estimate;
+        }
+        unsigned int bits[2];
+        doorkeeperBits(hash, bits);
+        for (unsigned int bit : bits){
+            if (!(m_doorkeeper[bit >> 6] & (1ULL << (bit & 63)))){
+                return estimate;
+            }
+        }
+        return estimate + 1;
+    }
+
+private:
+    vector<unsigned long long> m_counters;  // SKETCHDEPTH rows of m_width 4-bit counters
+    vector<unsigned long long> m_doorkeeper;// bloom filter of the hashes recorded once since the last aging
+    size_t      m_width;        // counters in each row
+    int         m_shift;        // 32 - log2(m_width), the multiply-shift hashes keep the top bits
+    uint64_t    m_samples;      // records that counted up a counter since the last aging
+    uint64_t    m_sampleSize;   // number of samples that triggers an aging
+
+    // returns the counter of a hash in a row
+    int index(unsigned int hash, int row) const {
+        return (hash * ROWMULTIPLIERS[row]) >> m_shift;
+    }
+    // sets the two doorkeeper bits of a hash, the doorkeeper has 8 times as many bits as a row has counters
+    void doorkeeperBits(unsigned int hash, unsigned int bits[2]) const {
+        for (int i = 0; i < 2; i++){
+            bits[i] = (hash * ROWMULTIPLIERS[SKETCHDEPTH + i]) >> (m_shift - 3);
+        }
+    }
+    // halves every counter (the shift moves the low bit of each counter into the high bit of the one below it, the
+    // mask clears it) and clears the doorkeeper
+    void age(){
+        for (unsigned long long& word : m_counters){
+            word = (word >> 1) & 0x7777777777777777ULL;
+        }
+        for (unsigned long long& word : m_doorkeeper){
+            word = 0;
+        }
+        m_samples /= 2;
+    }
+};
+#endif